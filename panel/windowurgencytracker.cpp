@@ -0,0 +1,146 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * LXQt - a lightweight, Qt based, desktop toolset
+ * https://lxqt.org
+ *
+ * Copyright: 2026 LXQt team
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "windowurgencytracker.h"
+
+#include <QCoreApplication>
+#include <KWindowSystem/KWindowSystem>
+#include <KWindowSystem/KWindowInfo>
+
+/************************************************
+
+ ************************************************/
+WindowUrgencyTracker * WindowUrgencyTracker::instance()
+{
+    static WindowUrgencyTracker * tracker = new WindowUrgencyTracker(QCoreApplication::instance());
+    return tracker;
+}
+
+/************************************************
+
+ ************************************************/
+WindowUrgencyTracker::WindowUrgencyTracker(QObject * parent)
+    : QObject(parent)
+{
+    connect(KWindowSystem::self(), static_cast<void (KWindowSystem::*)(WId, NET::Properties, NET::Properties2)>(&KWindowSystem::windowChanged)
+            , this, &WindowUrgencyTracker::onWindowChanged);
+    connect(KWindowSystem::self(), &KWindowSystem::windowRemoved, this, &WindowUrgencyTracker::onWindowRemoved);
+}
+
+/************************************************
+
+ ************************************************/
+void WindowUrgencyTracker::onWindowChanged(WId window, NET::Properties prop, NET::Properties2 /*prop2*/)
+{
+    const bool was_urgent = mUrgentWindows.contains(window);
+    // the desktop matters only for the urgent windows
+    if (!prop.testFlag(NET::WMState) && !(was_urgent && prop.testFlag(NET::WMDesktop)))
+        return;
+
+    KWindowInfo info(window, NET::WMState | NET::WMDesktop | NET::WMWindowType, NET::WM2TransientFor);
+    if (!info.valid())
+    {
+        onWindowRemoved(window);
+        return;
+    }
+
+    const bool urgent = info.hasState(NET::DemandsAttention);
+    if (was_urgent)
+    {
+        const int desktop = mUrgentWindows.value(window);
+        if (urgent && desktop == info.desktop())
+            return;
+        setUrgent(window, desktop, false);
+        if (!urgent)
+            return;
+    }
+    else if (!urgent || !isHighlightable(window, info.windowType(NET::AllTypesMask), info.state(), info.transientFor()))
+        return;
+
+    setUrgent(window, info.desktop(), true);
+}
+
+/************************************************
+
+ ************************************************/
+void WindowUrgencyTracker::onWindowRemoved(WId window)
+{
+    auto i = mUrgentWindows.constFind(window);
+    if (mUrgentWindows.cend() != i)
+        setUrgent(window, i.value(), false);
+}
+
+/************************************************
+
+ ************************************************/
+bool WindowUrgencyTracker::isHighlightable(WId window, NET::WindowType type, NET::States state, WId transientFor) const
+{
+    // this method was borrowed from the taskbar plugin
+    QFlags<NET::WindowTypeMask> ignoreList;
+    ignoreList |= NET::DesktopMask;
+    ignoreList |= NET::DockMask;
+    ignoreList |= NET::SplashMask;
+    ignoreList |= NET::ToolbarMask;
+    ignoreList |= NET::MenuMask;
+    ignoreList |= NET::PopupMenuMask;
+    ignoreList |= NET::NotificationMask;
+
+    if (NET::typeMatchesMask(type, ignoreList))
+        return false;
+
+    if (state & NET::SkipTaskbar)
+        return false;
+
+    // WM_TRANSIENT_FOR hint not set - normal window
+    // (the root window has no type, so the group transients are normal windows too)
+    if (transientFor == 0 || transientFor == window)
+        return true;
+
+    QFlags<NET::WindowTypeMask> normalFlag;
+    normalFlag |= NET::NormalMask;
+    normalFlag |= NET::DialogMask;
+    normalFlag |= NET::UtilityMask;
+
+    return !NET::typeMatchesMask(KWindowInfo(transientFor, NET::WMWindowType).windowType(NET::AllTypesMask), normalFlag);
+}
+
+/************************************************
+
+ ************************************************/
+void WindowUrgencyTracker::setUrgent(WId window, int desktop, bool urgent)
+{
+    if (urgent)
+    {
+        mUrgentWindows.insert(window, desktop);
+        ++mDesktopCounts[desktop];
+    }
+    else
+    {
+        mUrgentWindows.remove(window);
+        if (0 >= --mDesktopCounts[desktop])
+            mDesktopCounts.remove(desktop);
+    }
+    emit urgencyChanged(window, desktop, urgent);
+}
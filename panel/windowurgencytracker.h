@@ -0,0 +1,74 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * LXQt - a lightweight, Qt based, desktop toolset
+ * https://lxqt.org
+ *
+ * Copyright: 2026 LXQt team
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#ifndef WINDOWURGENCYTRACKER_H
+#define WINDOWURGENCYTRACKER_H
+
+#include <QObject>
+#include <QHash>
+#include <KWindowSystem/NETWM>
+#include "lxqtpanelglobals.h"
+
+/*! \brief Keeps track of the windows demanding attention (urgency hint).
+ *
+ * The window state is fetched only once per state change, no matter how many
+ * plugins are interested in it. The (more expensive) check whether the window
+ * should be highlighted at all is done only when it starts demanding attention.
+ */
+class LXQT_PANEL_API WindowUrgencyTracker : public QObject
+{
+    Q_OBJECT
+
+public:
+    static WindowUrgencyTracker * instance();
+
+    bool isUrgent(WId window) const { return mUrgentWindows.contains(window); }
+    //! \return number of the urgent windows on the desktop
+    int urgentCount(int desktop) const { return mDesktopCounts.value(desktop, 0); }
+
+signals:
+    /*! \brief Emitted when the window starts/stops demanding attention.
+     *
+     * When an urgent window is moved to another desktop, the signal is emitted
+     * with urgent == false for the old and with urgent == true for the new one.
+     */
+    void urgencyChanged(WId window, int desktop, bool urgent);
+
+private slots:
+    void onWindowChanged(WId window, NET::Properties prop, NET::Properties2 prop2);
+    void onWindowRemoved(WId window);
+
+private:
+    explicit WindowUrgencyTracker(QObject * parent = nullptr);
+
+    bool isHighlightable(WId window, NET::WindowType type, NET::States state, WId transientFor) const;
+    void setUrgent(WId window, int desktop, bool urgent);
+
+private:
+    QHash<WId, int> mUrgentWindows; //!< urgent windows -> their desktop
+    QHash<int, int> mDesktopCounts; //!< desktop -> number of urgent windows on it
+};
+
+#endif // WINDOWURGENCYTRACKER_H
@@ -39,6 +39,7 @@
 #include "desktopswitch.h"
 #include "desktopswitchbutton.h"
 #include "desktopswitchconfiguration.h"
+#include "../panel/windowurgencytracker.h"
 
 static const QString DEFAULT_SHORTCUT_TEMPLATE(QStringLiteral("Control+F%1"));
 
@@ -77,8 +78,7 @@ DesktopSwitch::DesktopSwitch(const ILXQtPanelPluginStartupInfo &startupInfo) :
     connect(KWindowSystem::self(), &KWindowSystem::currentDesktopChanged,   this, &DesktopSwitch::onCurrentDesktopChanged);
     connect(KWindowSystem::self(), &KWindowSystem::desktopNamesChanged,     this, &DesktopSwitch::onDesktopNamesChanged);
 
-    connect(KWindowSystem::self(), static_cast<void (KWindowSystem::*)(WId, NET::Properties, NET::Properties2)>(&KWindowSystem::windowChanged),
-            this, &DesktopSwitch::onWindowChanged);
+    connect(WindowUrgencyTracker::instance(), &WindowUrgencyTracker::urgencyChanged, this, &DesktopSwitch::onUrgencyChanged);
 }
 
 void DesktopSwitch::registerShortcuts()
@@ -120,17 +120,10 @@ void DesktopSwitch::shortcutRegistered()
     }
 }
 
-void DesktopSwitch::onWindowChanged(WId id, NET::Properties properties, NET::Properties2 /*properties2*/)
+void DesktopSwitch::onUrgencyChanged(WId id, int desktop, bool urgent)
 {
-    if (properties.testFlag(NET::WMState) && isWindowHighlightable(id))
-    {
-        KWindowInfo info(id, NET::WMDesktop | NET::WMState);
-        if (info.valid())
-        {
-            if (auto *button = m_buttons->button(info.desktop()))
-                reinterpret_cast<DesktopSwitchButton *>(button)->setUrgencyHint(id, info.hasState(NET::DemandsAttention));
-        }
-    }
+    if (auto *button = m_buttons->button(desktop))
+        reinterpret_cast<DesktopSwitchButton *>(button)->setUrgencyHint(id, urgent);
 }
 
 void DesktopSwitch::refresh()
@@ -175,43 +168,6 @@ void DesktopSwitch::refresh()
     }
 }
 
-bool DesktopSwitch::isWindowHighlightable(WId window)
-{
-    // this method was borrowed from the taskbar plugin
-    QFlags<NET::WindowTypeMask> ignoreList;
-    ignoreList |= NET::DesktopMask;
-    ignoreList |= NET::DockMask;
-    ignoreList |= NET::SplashMask;
-    ignoreList |= NET::ToolbarMask;
-    ignoreList |= NET::MenuMask;
-    ignoreList |= NET::PopupMenuMask;
-    ignoreList |= NET::NotificationMask;
-
-    KWindowInfo info(window, NET::WMWindowType | NET::WMState, NET::WM2TransientFor);
-    if (!info.valid())
-        return false;
-
-    if (NET::typeMatchesMask(info.windowType(NET::AllTypesMask), ignoreList))
-        return false;
-
-    if (info.state() & NET::SkipTaskbar)
-        return false;
-
-    // WM_TRANSIENT_FOR hint not set - normal window
-    WId transFor = info.transientFor();
-    if (transFor == 0 || transFor == window || transFor == (WId) QX11Info::appRootWindow())
-        return true;
-
-    info = KWindowInfo(transFor, NET::WMWindowType);
-
-    QFlags<NET::WindowTypeMask> normalFlag;
-    normalFlag |= NET::NormalMask;
-    normalFlag |= NET::DialogMask;
-    normalFlag |= NET::UtilityMask;
-
-    return !NET::typeMatchesMask(info.windowType(NET::AllTypesMask), normalFlag);
-}
-
 DesktopSwitch::~DesktopSwitch() = default;
 
 void DesktopSwitch::setDesktop(int desktop)
@@ -87,7 +87,6 @@ private:
     DesktopSwitchButton::LabelType mLabelType;
 
     void refresh();
-    bool isWindowHighlightable(WId window);
 
 private slots:
     void setDesktop(int desktop);
@@ -97,7 +96,7 @@ private slots:
     virtual void settingsChanged();
     void registerShortcuts();
     void shortcutRegistered();
-    void onWindowChanged(WId id, NET::Properties properties, NET::Properties2 properties2);
+    void onUrgencyChanged(WId id, int desktop, bool urgent);
 };
 
 class DesktopSwitchPluginLibrary: public QObject, public ILXQtPanelPluginLibrary
@@ -30,14 +30,38 @@
 SniAsync::SniAsync(const QString &service, const QString &path, const QDBusConnection &connection, QObject *parent/* = 0*/)
     : QObject(parent)
     , mSni{service, path, connection}
+    , mHasSnapshot{false}
+    , mGetAllUnsupported{false}
+    , mSerial{0}
+    , mGetAllInFlight{false}
 {
-    //forward StatusNotifierItem signals
-    connect(&mSni, &org::kde::StatusNotifierItem::NewAttentionIcon, this, &SniAsync::NewAttentionIcon);
-    connect(&mSni, &org::kde::StatusNotifierItem::NewIcon, this, &SniAsync::NewIcon);
-    connect(&mSni, &org::kde::StatusNotifierItem::NewOverlayIcon, this, &SniAsync::NewOverlayIcon);
-    connect(&mSni, &org::kde::StatusNotifierItem::NewStatus, this, &SniAsync::NewStatus);
-    connect(&mSni, &org::kde::StatusNotifierItem::NewTitle, this, &SniAsync::NewTitle);
-    connect(&mSni, &org::kde::StatusNotifierItem::NewToolTip, this, &SniAsync::NewToolTip);
+    //forward StatusNotifierItem signals (after marking the concerned properties stale)
+    connect(&mSni, &org::kde::StatusNotifierItem::NewAttentionIcon, this, [this] {
+        invalidate({QStringLiteral("AttentionIconName"), QStringLiteral("AttentionIconPixmap"), QStringLiteral("IconThemePath")});
+        emit NewAttentionIcon();
+    });
+    connect(&mSni, &org::kde::StatusNotifierItem::NewIcon, this, [this] {
+        invalidate({QStringLiteral("IconName"), QStringLiteral("IconPixmap"), QStringLiteral("IconThemePath")});
+        emit NewIcon();
+    });
+    connect(&mSni, &org::kde::StatusNotifierItem::NewOverlayIcon, this, [this] {
+        invalidate({QStringLiteral("OverlayIconName"), QStringLiteral("OverlayIconPixmap"), QStringLiteral("IconThemePath")});
+        emit NewOverlayIcon();
+    });
+    connect(&mSni, &org::kde::StatusNotifierItem::NewStatus, this, [this] (const QString &status) {
+        // the signal carries the value
+        if (isCached(QStringLiteral("Status")))
+            mProperties.insert(QStringLiteral("Status"), status);
+        emit NewStatus(status);
+    });
+    connect(&mSni, &org::kde::StatusNotifierItem::NewTitle, this, [this] {
+        invalidate({QStringLiteral("Title")});
+        emit NewTitle();
+    });
+    connect(&mSni, &org::kde::StatusNotifierItem::NewToolTip, this, [this] {
+        invalidate({QStringLiteral("ToolTip")});
+        emit NewToolTip();
+    });
 }
 
 QDBusPendingReply<QDBusVariant> SniAsync::asyncPropGet(QString const & property)
@@ -46,3 +70,130 @@ QDBusPendingReply<QDBusVariant> SniAsync::asyncPropGet(QString const & property)
     msg << mSni.interface() << property;
     return mSni.connection().asyncCall(msg);
 }
+
+bool SniAsync::isCached(QString const & name) const
+{
+    return (mHasSnapshot || mFetched.contains(name)) && !mStale.contains(name);
+}
+
+void SniAsync::requestProperty(QString const & name, PropertyCallback callback)
+{
+    if (isCached(name))
+    {
+        callback(mProperties.value(name));
+        return;
+    }
+
+    auto & waiting = mWaiting[name];
+    waiting << std::move(callback);
+    // the first read of the property starts the fetch
+    if (waiting.count() == 1 && !mGetAllInFlight && !mInFlight.contains(name))
+        fetch(name);
+}
+
+void SniAsync::fetch(QString const & name)
+{
+    const quint64 serial = mSerial;
+    // (a New* signal makes a few properties stale, those are cheaper to get
+    // one by one than to download all the pixmaps & tooltips again)
+    if (!mGetAllUnsupported && (!mHasSnapshot || mStale.count() * 2 > mProperties.count()))
+    {
+        mGetAllInFlight = true;
+        QDBusMessage msg = QDBusMessage::createMethodCall(mSni.service(), mSni.path(), QLatin1String("org.freedesktop.DBus.Properties"), QLatin1String("GetAll"));
+        msg << mSni.interface();
+        connect(new QDBusPendingCallWatcher{mSni.connection().asyncCall(msg), this}, &QDBusPendingCallWatcher::finished, this
+                , [this, serial] (QDBusPendingCallWatcher * call) { getAllFinished(call, serial); });
+    }
+    else
+    {
+        mInFlight << name;
+        connect(new QDBusPendingCallWatcher{asyncPropGet(name), this}, &QDBusPendingCallWatcher::finished, this
+                , [this, name, serial] (QDBusPendingCallWatcher * call) { getFinished(name, call, serial); });
+    }
+}
+
+void SniAsync::getAllFinished(QDBusPendingCallWatcher * call, quint64 serial)
+{
+    mGetAllInFlight = false;
+    QDBusPendingReply<QVariantMap> reply = *call;
+    call->deleteLater();
+    if (reply.isError())
+    {
+        qDebug().noquote().nospace() << "Error on DBus GetAll request(" << mSni.service() << ',' << mSni.path() << "): " << reply.error() << ", falling back to Get";
+        mGetAllUnsupported = true;
+    }
+    else
+    {
+        const QVariantMap values = reply.value();
+        mProperties.clear();
+        for (auto i = values.cbegin(); i != values.cend(); ++i)
+            mProperties.insert(i.key(), demarshall(i.value()));
+        mHasSnapshot = true;
+        // the properties invalidated after sending the request stay stale
+        for (auto i = mStale.begin(); i != mStale.end(); )
+        {
+            if (*i <= serial)
+                i = mStale.erase(i);
+            else
+                ++i;
+        }
+    }
+    deliverWaiting();
+}
+
+void SniAsync::getFinished(QString const & name, QDBusPendingCallWatcher * call, quint64 serial)
+{
+    mInFlight.remove(name);
+    QDBusPendingReply<QVariant> reply = *call;
+    call->deleteLater();
+    if (reply.isError())
+    {
+        qDebug().noquote().nospace() << "Error on DBus request(" << mSni.service() << ',' << mSni.path() << "): " << reply.error();
+        mProperties.remove(name);
+    }
+    else
+        mProperties.insert(name, demarshall(reply.value()));
+    mFetched << name;
+    if (mStale.value(name, 0) <= serial)
+        mStale.remove(name);
+    deliverWaiting();
+}
+
+void SniAsync::deliverWaiting()
+{
+    const QStringList names = mWaiting.keys();
+    for (QString const & name : names)
+    {
+        if (isCached(name))
+        {
+            // the callbacks may request other properties
+            const QVector<PropertyCallback> callbacks = mWaiting.take(name);
+            const QVariant value = mProperties.value(name);
+            for (PropertyCallback const & callback : callbacks)
+                callback(value);
+        }
+        else if (!mGetAllInFlight && !mInFlight.contains(name) && mWaiting.contains(name))
+            fetch(name);
+    }
+}
+
+void SniAsync::invalidate(QStringList const & properties)
+{
+    ++mSerial;
+    for (QString const & name : properties)
+        mStale.insert(name, mSerial);
+}
+
+QVariant SniAsync::demarshall(QVariant const & value)
+{
+    if (value.userType() != qMetaTypeId<QDBusArgument>())
+        return value;
+
+    const QDBusArgument argument = value.value<QDBusArgument>();
+    const QString signature = argument.currentSignature();
+    if (signature == QLatin1String("a(iiay)"))
+        return QVariant::fromValue(qdbus_cast<IconPixmapList>(argument));
+    if (signature == QLatin1String("(sa(iiay)ss)"))
+        return QVariant::fromValue(qdbus_cast<ToolTip>(argument));
+    return value;
+}
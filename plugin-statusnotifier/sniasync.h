@@ -29,6 +29,10 @@
 #define SNIASYNC_H
 
 #include <functional>
+#include <QHash>
+#include <QSet>
+#include <QVariantMap>
+#include <QVector>
 #include "statusnotifieriteminterface.h"
 
 template<typename>
@@ -63,25 +67,33 @@ template <typename> struct is_valid_signature : public std::false_type {};
 template <typename Arg>
 struct is_valid_signature<void (Arg)> : public std::true_type {};
 
+/*! \brief Asynchronous access to a StatusNotifierItem.
+ *
+ * The properties are fetched all at once (org.freedesktop.DBus.Properties.GetAll)
+ * and the reads are served from that snapshot. The New* signals mark just the
+ * properties they concern as stale, those are fetched again on the next read
+ * (by Get, unless most of the snapshot is stale). The reads of a property
+ * being fetched wait for the one request in flight. Items without a working GetAll
+ * are read property by property.
+ */
 class SniAsync : public QObject
 {
     Q_OBJECT
 public:
     SniAsync(const QString &service, const QString &path, const QDBusConnection &connection, QObject *parent = nullptr);
 
+    /*! \brief Calls \p finished with the value of the property (the default-constructed value on error).
+     *
+     * The call is synchronous if the cached value is up to date.
+     */
     template <typename F>
     inline void propertyGetAsync(QString const &name, F finished)
     {
         static_assert(is_valid_signature<typename call_signature<F>::type>::value, "need callable (lambda, *function, callable obj) (Arg) -> void");
-        connect(new QDBusPendingCallWatcher{asyncPropGet(name), this},
-                &QDBusPendingCallWatcher::finished,
-                [this, finished, name] (QDBusPendingCallWatcher * call)
+        using Arg = typename std::function<typename call_signature<F>::type>::argument_type;
+        requestProperty(name, [finished] (QVariant const & value)
                 {
-                    QDBusPendingReply<QVariant> reply = *call;
-                    if (reply.isError())
-                        qDebug().noquote().nospace() << "Error on DBus request(" << mSni.service() << ',' << mSni.path() << "): " << reply.error();
-                    finished(qdbus_cast<typename std::function<typename call_signature<F>::type>::argument_type>(reply.value()));
-                    call->deleteLater();
+                    finished(qdbus_cast<Arg>(value));
                 }
         );
     }
@@ -106,11 +118,33 @@ signals:
     void NewToolTip();
 
 private:
+    using PropertyCallback = std::function<void (QVariant const &)>;
+
     QDBusPendingReply<QDBusVariant> asyncPropGet(QString const & property);
+    void requestProperty(QString const & name, PropertyCallback callback);
+    void fetch(QString const & name);
+    void getAllFinished(QDBusPendingCallWatcher * call, quint64 serial);
+    void getFinished(QString const & name, QDBusPendingCallWatcher * call, quint64 serial);
+    //! calls the waiting callbacks of the properties which are up to date, fetches the others
+    void deliverWaiting();
+    void invalidate(QStringList const & properties);
+    bool isCached(QString const & name) const;
+    //! converts the (complex) values still in the D-Bus form, so the cached value can be read repeatedly
+    static QVariant demarshall(QVariant const & value);
 
 private:
     org::kde::StatusNotifierItem mSni;
 
+    QVariantMap mProperties; //!< the snapshot (a missing property is a default-constructed one)
+    bool mHasSnapshot; //!< all the properties were fetched (GetAll)
+    bool mGetAllUnsupported;
+    QSet<QString> mFetched; //!< the properties fetched one by one (without GetAll)
+    quint64 mSerial; //!< of the last invalidation
+    QHash<QString, quint64> mStale; //!< stale property -> serial of its invalidation
+    QHash<QString, QVector<PropertyCallback>> mWaiting; //!< the reads waiting for a fetch
+    QSet<QString> mInFlight; //!< the properties being fetched by Get
+    bool mGetAllInFlight;
+
 };
 
 #endif
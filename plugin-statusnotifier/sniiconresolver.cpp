@@ -0,0 +1,181 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * LXQt - a lightweight, Qt based, desktop toolset
+ * https://lxqt.org
+ *
+ * Copyright: 2026 LXQt team
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "sniiconresolver.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFutureWatcher>
+#include <QtConcurrent>
+
+namespace
+{
+    bool hasExtension(QString const & iconName)
+    {
+        return iconName.endsWith(QStringLiteral(".png"))
+            || iconName.endsWith(QStringLiteral(".svg"))
+            || iconName.endsWith(QStringLiteral(".xpm"));
+    }
+
+    void indexDir(QDir const & dir, SniIconResolver::Index & index, QStringList & dirs)
+    {
+        dirs << dir.absolutePath();
+        const QStringList files = dir.entryList(QDir::Files);
+        for (QString const & file : files)
+            index[file] << dir.absoluteFilePath(file);
+    }
+}
+
+SniIconResolver * SniIconResolver::instance()
+{
+    static SniIconResolver * resolver = new SniIconResolver{qApp};
+    return resolver;
+}
+
+SniIconResolver::SniIconResolver(QObject * parent)
+    : QObject(parent)
+{
+    connect(&mWatcher, &QFileSystemWatcher::directoryChanged, this, &SniIconResolver::themeChanged);
+}
+
+void SniIconResolver::resolve(QString const & themePath, QString const & iconName, QObject * context, std::function<void (QStringList const &)> finished)
+{
+    if (mIndexes.contains(themePath))
+    {
+        finished(lookup(themePath, iconName));
+        return;
+    }
+
+    auto & pending = mPending[themePath];
+    pending.append({iconName, context, std::move(finished)});
+    if (pending.count() > 1)
+        return; // the index is being built already
+
+    auto watcher = new QFutureWatcher<QPair<Index, QStringList>>{this};
+    connect(watcher, &QFutureWatcher<QPair<Index, QStringList>>::finished, this, [this, watcher, themePath]
+        {
+            const auto result = watcher->future().result();
+            indexBuilt(themePath, result.first, result.second);
+            watcher->deleteLater();
+        });
+    watcher->setFuture(QtConcurrent::run([themePath]
+        {
+            QStringList dirs;
+            Index index = buildIndex(themePath, dirs);
+            return qMakePair(index, dirs);
+        }));
+}
+
+QStringList SniIconResolver::lookup(QString const & themePath, QString const & iconName)
+{
+    const auto key = qMakePair(themePath, iconName);
+    auto cached = mCache.constFind(key);
+    if (cached != mCache.cend())
+        return *cached;
+
+    Index const & index = mIndexes[themePath];
+    QStringList files;
+    if (hasExtension(iconName))
+        files = index.value(iconName);
+    else
+    {
+        // by the extension, each in the scanning order (the theme directory first, then the hicolor tree)
+        files << index.value(iconName + QStringLiteral(".png"))
+            << index.value(iconName + QStringLiteral(".svg"))
+            << index.value(iconName + QStringLiteral(".xpm"));
+    }
+    mCache.insert(key, files);
+    return files;
+}
+
+void SniIconResolver::indexBuilt(QString const & themePath, Index const & index, QStringList const & dirs)
+{
+    mIndexes.insert(themePath, index);
+    for (QString const & dir : dirs)
+        mWatchedDirs.insert(dir, themePath);
+    if (!dirs.isEmpty())
+        mWatcher.addPaths(dirs);
+
+    const QVector<Request> requests = mPending.take(themePath);
+    for (Request const & request : requests)
+    {
+        if (request.context)
+            request.finished(lookup(themePath, request.iconName));
+    }
+}
+
+void SniIconResolver::themeChanged(QString const & dir)
+{
+    const QString themePath = mWatchedDirs.value(dir);
+    if (themePath.isNull())
+        return;
+
+    // the whole theme path is indexed again on the next request
+    mIndexes.remove(themePath);
+    for (auto i = mCache.begin(); i != mCache.end(); )
+    {
+        if (i.key().first == themePath)
+            i = mCache.erase(i);
+        else
+            ++i;
+    }
+    QStringList dirs;
+    for (auto i = mWatchedDirs.begin(); i != mWatchedDirs.end(); )
+    {
+        if (*i == themePath)
+        {
+            dirs << i.key();
+            i = mWatchedDirs.erase(i);
+        }
+        else
+            ++i;
+    }
+    mWatcher.removePaths(dirs);
+}
+
+SniIconResolver::Index SniIconResolver::buildIndex(QString const & themePath, QStringList & dirs)
+{
+    Index index;
+    QDir themeDir(themePath);
+    if (themePath.isEmpty() || !themeDir.exists())
+        return index;
+
+    indexDir(themeDir, index, dirs);
+
+    if (themeDir.cd(QStringLiteral("hicolor")) || (themeDir.cd(QStringLiteral("icons")) && themeDir.cd(QStringLiteral("hicolor"))))
+    {
+        dirs << themeDir.absolutePath();
+        const QStringList sizes = themeDir.entryList(QDir::AllDirs | QDir::NoDotAndDotDot);
+        for (QString const & size : sizes)
+        {
+            const QDir sizeDir(themeDir.filePath(size));
+            dirs << sizeDir.absolutePath();
+            const QStringList contexts = sizeDir.entryList(QDir::AllDirs | QDir::NoDotAndDotDot);
+            for (QString const & context : contexts)
+                indexDir(QDir(sizeDir.filePath(context)), index, dirs);
+        }
+    }
+    return index;
+}
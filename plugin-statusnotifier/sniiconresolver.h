@@ -0,0 +1,84 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * LXQt - a lightweight, Qt based, desktop toolset
+ * https://lxqt.org
+ *
+ * Copyright: 2026 LXQt team
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#ifndef SNIICONRESOLVER_H
+#define SNIICONRESOLVER_H
+
+#include <functional>
+#include <QFileSystemWatcher>
+#include <QHash>
+#include <QObject>
+#include <QPair>
+#include <QPointer>
+#include <QStringList>
+#include <QVector>
+
+/*! \brief Finds the icon files of the items providing their own icon theme (IconThemePath).
+ *
+ * The directories of a theme path are scanned once, in a worker thread, into an index
+ * (file name -> paths). The index is dropped when a scanned directory changes.
+ * The resolved (theme path, icon name) pairs are cached, so the items rotating
+ * their icon names (animations) don't touch the disk at all.
+ */
+class SniIconResolver : public QObject
+{
+    Q_OBJECT
+
+public:
+    using Index = QHash<QString, QStringList>; //!< file name -> paths
+
+    static SniIconResolver * instance();
+
+    /*! \brief Calls \p finished with the files of the icon (in the GUI thread,
+     * synchronously if the theme path is indexed already). Nothing is called if
+     * \p context is destroyed in the meantime.
+     */
+    void resolve(QString const & themePath, QString const & iconName, QObject * context, std::function<void (QStringList const &)> finished);
+
+private:
+    struct Request
+    {
+        QString iconName;
+        QPointer<QObject> context;
+        std::function<void (QStringList const &)> finished;
+    };
+
+    explicit SniIconResolver(QObject * parent = nullptr);
+
+    QStringList lookup(QString const & themePath, QString const & iconName);
+    void indexBuilt(QString const & themePath, Index const & index, QStringList const & dirs);
+    void themeChanged(QString const & dir);
+    //! runs in a worker thread
+    static Index buildIndex(QString const & themePath, QStringList & dirs);
+
+private:
+    QHash<QString, Index> mIndexes; //!< theme path -> index
+    QHash<QPair<QString, QString>, QStringList> mCache; //!< (theme path, icon name) -> files
+    QHash<QString, QVector<Request>> mPending; //!< the requests waiting for the index of the theme path
+    QHash<QString, QString> mWatchedDirs; //!< directory -> theme path
+    QFileSystemWatcher mWatcher;
+};
+
+#endif // SNIICONRESOLVER_H
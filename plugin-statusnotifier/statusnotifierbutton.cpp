@@ -28,11 +28,11 @@
 
 #include "statusnotifierbutton.h"
 
-#include <QDir>
-#include <QFile>
 #include <dbusmenu-qt5/dbusmenuimporter.h>
 #include "../panel/ilxqtpanelplugin.h"
 #include "sniasync.h"
+#include "sniiconresolver.h"
+#include "statusnotifiericonstore.h"
 #include <XdgIcon>
 
 namespace
@@ -53,13 +53,14 @@ namespace
     };
 }
 
-StatusNotifierButton::StatusNotifierButton(QString service, QString objectPath, ILXQtPanelPlugin* plugin, QWidget *parent)
+StatusNotifierButton::StatusNotifierButton(QString service, QString objectPath, ILXQtPanelPlugin* plugin, StatusNotifierIconStore *iconStore, QWidget *parent)
     : QToolButton(parent),
     mMenu(nullptr),
     mStatus(Passive),
     mFallbackIcon(QIcon::fromTheme(QLatin1String("application-x-executable"))),
     mPlugin(plugin),
-    mAutoHide(false)
+    mAutoHide(false),
+    mIconStore(iconStore)
 {
     setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
     setAutoRaise(true);
@@ -101,6 +102,10 @@ StatusNotifierButton::StatusNotifierButton(QString service, QString objectPath,
 
     newToolTip();
 
+    // the icon changes are merged and rate limited
+    mRefetchTimer.setSingleShot(true);
+    connect(&mRefetchTimer, &QTimer::timeout, this, &StatusNotifierButton::refetchPending);
+
     // The timer that hides an auto-hiding button after it gets attention:
     mHideTimer.setSingleShot(true);
     mHideTimer.setInterval(300000);
@@ -112,6 +117,8 @@ StatusNotifierButton::StatusNotifierButton(QString service, QString objectPath,
 
 StatusNotifierButton::~StatusNotifierButton()
 {
+    for (Status status : {Passive, Active, NeedsAttention})
+        releasePixmapIcon(status);
     delete interface;
 }
 
@@ -120,29 +127,73 @@ void StatusNotifierButton::newIcon()
     if (!icon().isNull() && icon().name() != QLatin1String("application-x-executable"))
         onNeedingAttention();
 
-    interface->propertyGetAsync(QLatin1String("IconThemePath"), [this] (QString value) {
-        refetchIcon(Passive, value);
-    });
+    scheduleRefetch(Passive);
 }
 
 void StatusNotifierButton::newOverlayIcon()
 {
     onNeedingAttention();
 
-    interface->propertyGetAsync(QLatin1String("IconThemePath"), [this] (QString value) {
-        refetchIcon(Active, value);
-    });
+    scheduleRefetch(Active);
 }
 
 void StatusNotifierButton::newAttentionIcon()
 {
     onNeedingAttention();
 
-    interface->propertyGetAsync(QLatin1String("IconThemePath"), [this] (QString value) {
-        refetchIcon(NeedsAttention, value);
+    scheduleRefetch(NeedsAttention);
+}
+
+void StatusNotifierButton::setMaxIconUpdates(int updatesPerSecond)
+{
+    mRefetchInterval = 0 < updatesPerSecond ? 1000 / updatesPerSecond : 0;
+}
+
+void StatusNotifierButton::scheduleRefetch(Status status)
+{
+    if (mPendingRefetch & (1 << status))
+        ++mDroppedIconUpdates; // the waiting refetch brings the latest icon
+    mPendingRefetch |= 1 << status;
+    startRefetchTimer();
+}
+
+void StatusNotifierButton::startRefetchTimer()
+{
+    // at most one refetch in flight, the next one after it finishes
+    if (mRefetchesInFlight > 0 || mRefetchTimer.isActive())
+        return;
+    int delay = 0;
+    if (mLastRefetch.isValid())
+        delay = qMax(0, mRefetchInterval - static_cast<int>(mLastRefetch.elapsed()));
+    mRefetchTimer.start(delay);
+}
+
+void StatusNotifierButton::refetchPending()
+{
+    const int pending = mPendingRefetch;
+    if (0 == pending || mRefetchesInFlight > 0)
+        return;
+    mPendingRefetch = 0;
+    mLastRefetch.start();
+
+    ++mRefetchesInFlight; // for the theme path
+    interface->propertyGetAsync(QLatin1String("IconThemePath"), [this, pending] (QString value) {
+        for (Status status : {Passive, Active, NeedsAttention})
+        {
+            if (pending & (1 << status))
+                refetchIcon(status, value);
+        }
+        refetchFinished();
     });
 }
 
+void StatusNotifierButton::refetchFinished()
+{
+    // the changes meanwhile
+    if (--mRefetchesInFlight == 0 && 0 != mPendingRefetch)
+        startRefetchTimer();
+}
+
 void StatusNotifierButton::refetchIcon(Status status, const QString& themePath)
 {
     QString nameProperty, pixmapProperty;
@@ -162,120 +213,89 @@ void StatusNotifierButton::refetchIcon(Status status, const QString& themePath)
         pixmapProperty = QLatin1String("IconPixmap");
     }
 
-    interface->propertyGetAsync(nameProperty, [this, status, pixmapProperty, themePath] (QString iconName) {
+    const quint32 serial = ++mIconSerials[status];
+    ++mRefetchesInFlight;
+    interface->propertyGetAsync(nameProperty, [this, status, serial, pixmapProperty, themePath] (QString iconName) {
         if (!iconName.isEmpty())
         {
+            releasePixmapIcon(status);
             QIcon nextIcon = QIcon::fromTheme(iconName);
             if (nextIcon.isNull())
             {
-                QDir themeDir(themePath);
-                if (themeDir.exists())
-                {
-                    bool hasExtension = iconName.endsWith(QStringLiteral(".png"))
-                                        || iconName.endsWith(QStringLiteral(".svg"))
-                                        || iconName.endsWith(QStringLiteral(".xpm"));
-                    if (hasExtension)
-                    { // extension is included
-                        if (themeDir.exists(iconName))
-                            nextIcon.addFile(themeDir.filePath(iconName));
-                    }
-                    else
-                    {
-                        if (themeDir.exists(iconName + QStringLiteral(".png")))
-                            nextIcon.addFile(themeDir.filePath(iconName + QStringLiteral(".png")));
-                        if (themeDir.exists(iconName + QStringLiteral(".svg")))
-                            nextIcon.addFile(themeDir.filePath(iconName + QStringLiteral(".svg")));
-                        if (themeDir.exists(iconName + QStringLiteral(".xpm")))
-                            nextIcon.addFile(themeDir.filePath(iconName + QStringLiteral(".xpm")));
-                    }
-
-                    if (themeDir.cd(QStringLiteral("hicolor")) || (themeDir.cd(QStringLiteral("icons")) && themeDir.cd(QStringLiteral("hicolor"))))
-                    {
-                        const QStringList sizes = themeDir.entryList(QDir::AllDirs | QDir::NoDotAndDotDot);
-                        for (const QString &dir : sizes)
-                        {
-                            const QStringList dirs = QDir(themeDir.filePath(dir)).entryList(QDir::AllDirs | QDir::NoDotAndDotDot);
-                            for (const QString &innerDir : dirs)
-                            {
-                                QString path = themeDir.absolutePath() + QLatin1Char('/') + dir + QLatin1Char('/') + innerDir + QLatin1Char('/') + iconName;
-                                if (hasExtension)
-                                { // extension is included
-                                    if (QFile::exists(path))
-                                        nextIcon.addFile(path);
-                                }
-                                else
-                                {
-                                    if (QFile::exists(path + QStringLiteral(".png")))
-                                        nextIcon.addFile(path + QStringLiteral(".png"));
-                                    if (QFile::exists(path + QStringLiteral(".svg")))
-                                        nextIcon.addFile(path + QStringLiteral(".svg"));
-                                    if (QFile::exists(path + QStringLiteral(".xpm")))
-                                        nextIcon.addFile(path + QStringLiteral(".xpm"));
-                                }
-                            }
-                        }
-                    }
-                }
-            }
-
-            switch (status)
-            {
-                case Active:
-                    mOverlayIcon = nextIcon;
-                    break;
-                case NeedsAttention:
-                    mAttentionIcon = nextIcon;
-                    break;
-                case Passive:
-                    mIcon = nextIcon;
-                    break;
+                // the item's own theme directory, resolved (and cached) off the GUI thread
+                SniIconResolver::instance()->resolve(themePath, iconName, this, [this, status, serial] (QStringList const & files) {
+                    QIcon nextIcon;
+                    for (QString const & file : files)
+                        nextIcon.addFile(file);
+                    setStatusIcon(status, serial, nextIcon);
+                });
             }
-
-            resetIcon();
+            else
+                setStatusIcon(status, serial, nextIcon);
         }
         else
         {
-            interface->propertyGetAsync(pixmapProperty, [this, status, pixmapProperty] (IconPixmapList iconPixmaps) {
+            interface->propertyGetAsync(pixmapProperty, [this, status, serial] (IconPixmapList iconPixmaps) {
                 if (iconPixmaps.empty())
+                {
+                    refetchFinished();
                     return;
+                }
 
-                QIcon nextIcon;
-
-                for (IconPixmap iconPixmap: iconPixmaps)
+                if (serial != mIconSerials[status] || !mIconStore)
                 {
-                    if (!iconPixmap.bytes.isNull())
-                    {
-                        QImage image((uchar*) iconPixmap.bytes.data(), iconPixmap.width,
-                                     iconPixmap.height, QImage::Format_ARGB32);
-
-                        const uchar *end = image.constBits() + image.sizeInBytes();
-                        uchar *dest = reinterpret_cast<uchar*>(iconPixmap.bytes.data());
-                        for (const uchar *src = image.constBits(); src < end; src += 4, dest += 4)
-                            qToUnaligned(qToBigEndian<quint32>(qFromUnaligned<quint32>(src)), dest);
-
-                        nextIcon.addPixmap(QPixmap::fromImage(image));
-                    }
+                    refetchFinished();
+                    return;
                 }
-
-                switch (status)
+                // the same pixels as the last time (e.g. NewIcon for a changed name only) -> nothing to decode
+                if (0 != mPixmapKeys[status] && mIconStore->find(iconPixmaps) == mPixmapKeys[status])
                 {
-                    case Active:
-                        mOverlayIcon = nextIcon;
-                        break;
-                    case NeedsAttention:
-                        mAttentionIcon = nextIcon;
-                        break;
-                    case Passive:
-                        mIcon = nextIcon;
-                        break;
+                    refetchFinished();
+                    return;
                 }
 
-                resetIcon();
+                // identical pixmaps (of other items too) are decoded once and shared
+                quint64 key;
+                const QIcon nextIcon = mIconStore->acquire(iconPixmaps, key);
+                releasePixmapIcon(status);
+                mPixmapKeys[status] = key;
+                setStatusIcon(status, serial, nextIcon);
             });
         }
     });
 }
 
+void StatusNotifierButton::releasePixmapIcon(Status status)
+{
+    if (0 != mPixmapKeys[status] && mIconStore)
+        mIconStore->release(mPixmapKeys[status]);
+    mPixmapKeys[status] = 0;
+}
+
+void StatusNotifierButton::setStatusIcon(Status status, quint32 serial, const QIcon &icon)
+{
+    refetchFinished();
+
+    // an older (resolved later) icon must not replace the newer one
+    if (serial != mIconSerials[status])
+        return;
+
+    switch (status)
+    {
+        case Active:
+            mOverlayIcon = icon;
+            break;
+        case NeedsAttention:
+            mAttentionIcon = icon;
+            break;
+        case Passive:
+            mIcon = icon;
+            break;
+    }
+
+    resetIcon();
+}
+
 void StatusNotifierButton::newToolTip()
 {
     interface->propertyGetAsync(QLatin1String("ToolTip"), [this] (ToolTip tooltip) {
@@ -37,16 +37,21 @@
 #include <QWheelEvent>
 #include <QMenu>
 #include <QTimer>
+#include <QPointer>
+#include <QElapsedTimer>
 
 class ILXQtPanelPlugin;
 class SniAsync;
+class StatusNotifierIconStore;
 
 class StatusNotifierButton : public QToolButton
 {
     Q_OBJECT
+    //! the icon changes which were merged into a later one (instrumentation)
+    Q_PROPERTY(int droppedIconUpdates READ droppedIconUpdates)
 
 public:
-    StatusNotifierButton(QString service, QString objectPath, ILXQtPanelPlugin* plugin,  QWidget *parent = nullptr);
+    StatusNotifierButton(QString service, QString objectPath, ILXQtPanelPlugin* plugin, StatusNotifierIconStore *iconStore, QWidget *parent = nullptr);
     ~StatusNotifierButton();
 
     enum Status
@@ -59,6 +64,11 @@ public:
     }
     bool hasAttention() const;
     void setAutoHide(bool autoHide, int minutes = 5, bool forcedVisible = false);
+    /*! Sets the maximal number of icon refetches per second, 0 means no limit.
+     * The New*Icon signals coming faster are merged, the latest icon wins.
+     */
+    void setMaxIconUpdates(int updatesPerSecond);
+    int droppedIconUpdates() const { return mDroppedIconUpdates; }
 
 signals:
     void titleFound(const QString &title);
@@ -73,18 +83,31 @@ public slots:
 
 private:
     void onNeedingAttention();
+    void scheduleRefetch(Status status);
+    void startRefetchTimer();
+    void refetchPending();
+    void refetchFinished();
 
     SniAsync *interface;
     QMenu *mMenu;
     Status mStatus;
 
     QIcon mIcon, mOverlayIcon, mAttentionIcon, mFallbackIcon;
+    quint32 mIconSerials[3] = {0, 0, 0}; //!< of the last icon fetch per status
+    quint64 mPixmapKeys[3] = {0, 0, 0}; //!< the store keys of the pixmaps the current icons were decoded from
+    int mPendingRefetch = 0; //!< statuses (bits) whose icon changed since the last refetch
+    int mRefetchesInFlight = 0;
+    int mRefetchInterval = 0; //!< minimal interval between the refetches (ms)
+    QTimer mRefetchTimer;
+    QElapsedTimer mLastRefetch;
+    int mDroppedIconUpdates = 0;
 
     ILXQtPanelPlugin* mPlugin;
 
     QString mTitle;
     bool mAutoHide;
     QTimer mHideTimer;
+    QPointer<StatusNotifierIconStore> mIconStore; //!< (the widget may destroy it before the buttons)
 
 protected:
     void contextMenuEvent(QContextMenuEvent * event);
@@ -92,6 +115,8 @@ protected:
     void wheelEvent(QWheelEvent *event);
 
     void refetchIcon(Status status, const QString& themePath);
+    void setStatusIcon(Status status, quint32 serial, const QIcon &icon);
+    void releasePixmapIcon(Status status);
     void resetIcon();
 };
 
@@ -0,0 +1,171 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * LXQt - a lightweight, Qt based, desktop toolset
+ * https://lxqt.org
+ *
+ * Copyright: 2026 LXQt team
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "statusnotifiericonstore.h"
+
+#include <QImage>
+#include <QPixmap>
+#include <QtEndian>
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    /*! \brief Copies the IconPixmap pixels (ARGB32 in the network byte order)
+     * to \p dest in the host order.
+     */
+    void fromNetworkArgb(const uchar *src, uchar *dest, int count)
+    {
+        int i = 0;
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+#if defined(__SSSE3__)
+        const __m128i reverse = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+        for (; i + 4 <= count; i += 4)
+        {
+            const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 4));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dest + i * 4), _mm_shuffle_epi8(pixels, reverse));
+        }
+#elif defined(__SSE2__)
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 4));
+            // swap the bytes of the 16-bit halves, then the halves
+            pixels = _mm_or_si128(_mm_slli_epi16(pixels, 8), _mm_srli_epi16(pixels, 8));
+            pixels = _mm_shufflehi_epi16(_mm_shufflelo_epi16(pixels, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dest + i * 4), pixels);
+        }
+#endif
+#endif
+        for (; i < count; ++i)
+            qToUnaligned(qFromBigEndian<quint32>(src + i * 4), dest + i * 4);
+    }
+}
+
+quint64 StatusNotifierIconStore::contentKey(const IconPixmapList &pixmaps)
+{
+    // (the halves aren't independent, qHash is linear in the seed; the collisions
+    // are resolved by comparing the pixmaps)
+    uint low = 0, high = 0x9e3779b9;
+    for (const IconPixmap &pixmap : pixmaps)
+    {
+        const uint size = qHash(qMakePair(pixmap.width, pixmap.height));
+        low = qHash(pixmap.bytes, low ^ size);
+        high = qHash(pixmap.bytes, high + size);
+    }
+    const quint64 key = (static_cast<quint64>(high) << 32) | low;
+    return 0 == key ? 1 : key;
+}
+
+bool StatusNotifierIconStore::samePixmaps(const IconPixmapList &a, const IconPixmapList &b)
+{
+    if (a.count() != b.count())
+        return false;
+    for (int i = 0; i < a.count(); ++i)
+    {
+        if (a[i].width != b[i].width || a[i].height != b[i].height || a[i].bytes != b[i].bytes)
+            return false;
+    }
+    return true;
+}
+
+quint64 StatusNotifierIconStore::lookup(const IconPixmapList &pixmaps, bool &found) const
+{
+    // linear probing (a key freed in the middle of a chain means just a duplicate decode later)
+    quint64 key = contentKey(pixmaps);
+    for (auto i = mIcons.constFind(key); i != mIcons.cend(); i = mIcons.constFind(key))
+    {
+        if (samePixmaps(i->pixmaps, pixmaps))
+        {
+            found = true;
+            return key;
+        }
+        if (0 == ++key)
+            key = 1;
+    }
+    found = false;
+    return key;
+}
+
+quint64 StatusNotifierIconStore::find(const IconPixmapList &pixmaps) const
+{
+    bool found;
+    const quint64 key = lookup(pixmaps, found);
+    return found ? key : 0;
+}
+
+QIcon StatusNotifierIconStore::acquire(const IconPixmapList &pixmaps, quint64 &key)
+{
+    bool found;
+    key = lookup(pixmaps, found);
+    auto i = mIcons.find(key);
+    if (!found)
+    {
+        Entry entry;
+        entry.icon = decode(pixmaps, entry.bytes);
+        entry.pixmaps = pixmaps;
+        entry.refs = 0;
+        mMemoryUsage += entry.bytes;
+        i = mIcons.insert(key, entry);
+        emit changed();
+    }
+    ++i->refs;
+    return i->icon;
+}
+
+void StatusNotifierIconStore::release(quint64 key)
+{
+    auto i = mIcons.find(key);
+    if (i == mIcons.end() || --i->refs > 0)
+        return;
+
+    mMemoryUsage -= i->bytes;
+    mIcons.erase(i);
+    emit changed();
+}
+
+QIcon StatusNotifierIconStore::decode(const IconPixmapList &pixmaps, qint64 &bytes)
+{
+    QIcon icon;
+    bytes = 0;
+    for (const IconPixmap &iconPixmap : pixmaps)
+    {
+        if (iconPixmap.width > 0 && iconPixmap.height > 0
+            && iconPixmap.bytes.size() >= iconPixmap.width * iconPixmap.height * 4)
+        {
+            QImage image(iconPixmap.width, iconPixmap.height, QImage::Format_ARGB32);
+            for (int y = 0; y < image.height(); ++y)
+                fromNetworkArgb(reinterpret_cast<const uchar *>(iconPixmap.bytes.constData()) + y * image.width() * 4, image.scanLine(y), image.width());
+            // the pixmap is premultiplied anyway, convert in place (the Qt's SIMD kernels)
+            image.convertTo(QImage::Format_ARGB32_Premultiplied);
+            bytes += image.sizeInBytes();
+
+            icon.addPixmap(QPixmap::fromImage(std::move(image)));
+        }
+    }
+    return icon;
+}
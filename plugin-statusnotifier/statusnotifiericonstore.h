@@ -0,0 +1,93 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * LXQt - a lightweight, Qt based, desktop toolset
+ * https://lxqt.org
+ *
+ * Copyright: 2026 LXQt team
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#ifndef STATUSNOTIFIERICONSTORE_H
+#define STATUSNOTIFIERICONSTORE_H
+
+#include <QHash>
+#include <QIcon>
+#include <QObject>
+
+#include "dbustypes.h"
+
+/*! \brief The icons decoded from the IconPixmap data, shared between the items.
+ *
+ * Several items (e.g. instances of the same application) tend to publish identical
+ * pixmaps. The icons are keyed by the content of the pixmaps, so such pixmaps
+ * are decoded (and uploaded) only once. The icons are reference counted,
+ * an icon is dropped when no button uses it anymore.
+ *
+ * The pixmaps are compared on a key hit, the colliding ones take the next free key.
+ */
+class StatusNotifierIconStore : public QObject
+{
+    Q_OBJECT
+    //! bytes taken by the decoded pixmaps
+    Q_PROPERTY(qint64 memoryUsage READ memoryUsage NOTIFY changed)
+    Q_PROPERTY(int iconCount READ iconCount NOTIFY changed)
+
+public:
+    using QObject::QObject;
+
+    //! \return the key of the icon of the pixmaps (0 if not in the store)
+    quint64 find(const IconPixmapList &pixmaps) const;
+
+    /*! \brief \return the icon of the pixmaps (decoded if not in the store yet)
+     * and takes a reference to it
+     * \param key set to the key of the icon (for the release())
+     */
+    QIcon acquire(const IconPixmapList &pixmaps, quint64 &key);
+    void release(quint64 key);
+
+    qint64 memoryUsage() const { return mMemoryUsage; }
+    int iconCount() const { return mIcons.count(); }
+
+signals:
+    void changed();
+
+private:
+    //! \return the hash of the pixmaps (never 0)
+    static quint64 contentKey(const IconPixmapList &pixmaps);
+    static bool samePixmaps(const IconPixmapList &a, const IconPixmapList &b);
+    /*! \return the key of the icon of the pixmaps if in the store, the free key
+     * to store them under otherwise (see \p found)
+     */
+    quint64 lookup(const IconPixmapList &pixmaps, bool &found) const;
+    static QIcon decode(const IconPixmapList &pixmaps, qint64 &bytes);
+
+private:
+    struct Entry
+    {
+        QIcon icon;
+        IconPixmapList pixmaps; //!< the source (shared data, for resolving the key collisions)
+        int refs;
+        qint64 bytes;
+    };
+
+    QHash<quint64, Entry> mIcons;
+    qint64 mMemoryUsage = 0;
+};
+
+#endif // STATUSNOTIFIERICONSTORE_H
@@ -27,6 +27,7 @@
  * END_COMMON_COPYRIGHT_HEADER */
 
 #include "statusnotifierwatcher.h"
+#include <algorithm>
 #include <QDebug>
 #include <QDBusConnectionInterface>
 
@@ -66,27 +67,52 @@ StatusNotifierWatcher::~StatusNotifierWatcher()
     QDBusConnection::sessionBus().unregisterService(QStringLiteral("org.kde.StatusNotifierWatcher"));
 }
 
+QString StatusNotifierWatcher::notifierItemId(const QString &serviceOrPath) const
+{
+    // workaround for sni-qt (and the items sharing one connection): registration by path
+    if (serviceOrPath.startsWith(QLatin1Char('/')))
+        return message().service() + serviceOrPath;
+
+    return serviceOrPath + QStringLiteral("/StatusNotifierItem");
+}
+
+void StatusNotifierWatcher::watchService(const QString &service)
+{
+    // one service may provide several items
+    if (!mWatcher->watchedServices().contains(service))
+        mWatcher->addWatchedService(service);
+}
+
 void StatusNotifierWatcher::RegisterStatusNotifierItem(const QString &serviceOrPath)
 {
-    QString service = serviceOrPath;
-    QString path = QStringLiteral("/StatusNotifierItem");
+    QString notifierItemId = this->notifierItemId(serviceOrPath);
+    QString service = notifierItemId.left(notifierItemId.indexOf(QLatin1Char('/')));
 
-    // workaround for sni-qt
-    if (service.startsWith(QLatin1Char('/')))
+    if (!mServices.contains(notifierItemId)
+        && QDBusConnection::sessionBus().interface()->isServiceRegistered(service).value())
     {
-        path = service;
-        service = message().service();
+        mServices << notifierItemId;
+        watchService(service);
+        emit StatusNotifierItemRegistered(notifierItemId);
     }
+}
 
-    QString notifierItemId = service + path;
+void StatusNotifierWatcher::UnregisterStatusNotifierItem(const QString &serviceOrPath)
+{
+    QString notifierItemId = this->notifierItemId(serviceOrPath);
+    if (!mServices.removeOne(notifierItemId))
+        return;
 
-    if (QDBusConnection::sessionBus().interface()->isServiceRegistered(service).value()
-        && !mServices.contains(notifierItemId))
+    // stop watching the service with its last item
+    QString service = notifierItemId.left(notifierItemId.indexOf(QLatin1Char('/')));
+    QString match = service + QLatin1Char('/');
+    if (!mHosts.contains(service)
+        && std::none_of(mServices.cbegin(), mServices.cend(), [&match] (const QString &id) { return id.startsWith(match); }))
     {
-        mServices << notifierItemId;
-        mWatcher->addWatchedService(service);
-        emit StatusNotifierItemRegistered(notifierItemId);
+        mWatcher->removeWatchedService(service);
     }
+
+    emit StatusNotifierItemUnregistered(notifierItemId);
 }
 
 void StatusNotifierWatcher::RegisterStatusNotifierHost(const QString &service)
@@ -94,7 +120,7 @@ void StatusNotifierWatcher::RegisterStatusNotifierHost(const QString &service)
     if (!mHosts.contains(service))
     {
         mHosts.append(service);
-        mWatcher->addWatchedService(service);
+        watchService(service);
     }
 }
 
@@ -60,10 +60,17 @@ signals:
 
 public slots:
     Q_SCRIPTABLE void RegisterStatusNotifierItem(const QString &serviceOrPath);
+    //! non-standard counterpart, lets one service provide (and remove) several items by path
+    Q_SCRIPTABLE void UnregisterStatusNotifierItem(const QString &serviceOrPath);
     Q_SCRIPTABLE void RegisterStatusNotifierHost(const QString &service);
 
     void serviceUnregistered(const QString &service);
 
+private:
+    //! \return the item id (service + path) of the registration argument
+    QString notifierItemId(const QString &serviceOrPath) const;
+    void watchService(const QString &service);
+
 private:
     QStringList mServices;
     QStringList mHosts;
@@ -29,16 +29,22 @@
 #include "statusnotifierwidget.h"
 #include "statusnotifierproxy.h"
 #include "../panel/pluginsettings.h"
+#include "statusnotifiericonstore.h"
 #include "../panel/ilxqtpanelplugin.h"
 
 StatusNotifierWidget::StatusNotifierWidget(ILXQtPanelPlugin *plugin, QWidget *parent) :
     QWidget(parent),
     mPlugin(plugin),
     mAttentionPeriod(5),
+    mMaxIconUpdates(10),
     mForceVisible(false)
 {
     setLayout(new LXQt::GridLayout(this));
 
+    // the icons shared by the items (inspect its memoryUsage property for monitoring)
+    mIconStore = new StatusNotifierIconStore(this);
+    mIconStore->setObjectName(QStringLiteral("StatusNotifierIconStore"));
+
     // The button that shows all hidden items:
     mShowBtn = new QToolButton(this);
     mShowBtn->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
@@ -106,7 +112,8 @@ void StatusNotifierWidget::itemAdded(QString serviceAndPath)
     int slash = serviceAndPath.indexOf(QLatin1Char('/'));
     QString serv = serviceAndPath.left(slash);
     QString path = serviceAndPath.mid(slash);
-    StatusNotifierButton *button = new StatusNotifierButton(serv, path, mPlugin, this);
+    StatusNotifierButton *button = new StatusNotifierButton(serv, path, mPlugin, mIconStore, this);
+    button->setMaxIconUpdates(mMaxIconUpdates);
 
     mServices.insert(serviceAndPath, button);
     layout()->addWidget(button);
@@ -199,12 +206,14 @@ void StatusNotifierWidget::settingsChanged()
     mAttentionPeriod = mPlugin->settings()->value(QStringLiteral("attentionPeriod"), 5).toInt();
     mAutoHideList = mPlugin->settings()->value(QStringLiteral("autoHideList")).toStringList();
     mHideList = mPlugin->settings()->value(QStringLiteral("hideList")).toStringList();
+    mMaxIconUpdates = mPlugin->settings()->value(QStringLiteral("maxIconUpdates"), 10).toInt();
 
     // show/hide items as well as showBtn appropriately
     const auto allButtons = findChildren<StatusNotifierButton *>(QString(), Qt::FindDirectChildrenOnly);
     bool showBtn = false;
     for (const auto &btn : allButtons)
     {
+        btn->setMaxIconUpdates(mMaxIconUpdates);
         if (mAutoHideList.contains(btn->title()))
         {
             btn->setAutoHide(true, mAttentionPeriod);
@@ -35,6 +35,7 @@
 #include "statusnotifierbutton.h"
 
 class StatusNotifierProxy;
+class StatusNotifierIconStore;
 
 class StatusNotifierWidget : public QWidget
 {
@@ -61,6 +62,7 @@ protected:
 
 private:
     ILXQtPanelPlugin *mPlugin;
+    StatusNotifierIconStore *mIconStore;
 
     QTimer mHideTimer;
 
@@ -71,5 +73,6 @@ private:
     QStringList mHideList;
     QToolButton *mShowBtn;
     int mAttentionPeriod;
+    int mMaxIconUpdates; //!< per second and item
     bool mForceVisible;
 };
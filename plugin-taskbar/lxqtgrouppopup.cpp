@@ -29,6 +29,7 @@
  * END_COMMON_COPYRIGHT_HEADER */
 
 #include "lxqtgrouppopup.h"
+#include "lxqttaskthumbnailer.h"
 #include <QEnterEvent>
 #include <QDrag>
 #include <QMimeData>
@@ -60,28 +61,56 @@ LXQtGroupPopup::LXQtGroupPopup(LXQtTaskGroup *group):
 
 LXQtGroupPopup::~LXQtGroupPopup() = default;
 
-void LXQtGroupPopup::dropEvent(QDropEvent *event)
+/************************************************
+
+ ************************************************/
+void LXQtGroupPopup::addButton(LXQtTaskButton* button)
+{
+    layout()->addWidget(button);
+    if (isVisible())
+        watchThumbnail(button);
+}
+
+/************************************************
+
+ ************************************************/
+void LXQtGroupPopup::removeWidget(QWidget *button)
 {
-    qlonglong temp;
-    QDataStream stream(event->mimeData()->data(LXQtTaskButton::mimeDataFormat()));
-    stream >> temp;
-    WId window = (WId) temp;
+    layout()->removeWidget(button);
+    if (isVisible())
+        if (LXQtTaskButton * b = qobject_cast<LXQtTaskButton *>(button))
+            unwatchThumbnail(b);
+}
 
-    LXQtTaskButton *button = nullptr;
-    int oldIndex(0);
-    // get current position of the button being dragged
-    for (int i = 0; i < layout()->count(); i++)
+void LXQtGroupPopup::dropEvent(QDropEvent *event)
+{
+    LXQtTaskButton *button = qobject_cast<LXQtTaskButton *>(event->source());
+    int oldIndex = -1;
+    if (button)
+    {
+        // in-process drag -> the dragged button is known
+        oldIndex = layout()->indexOf(button);
+    } else if (event->mimeData()->hasFormat(LXQtTaskButton::mimeDataFormat()))
     {
-        LXQtTaskButton *b = qobject_cast<LXQtTaskButton*>(layout()->itemAt(i)->widget());
-        if (b && b->windowId() == window)
+        qlonglong temp;
+        QDataStream stream(event->mimeData()->data(LXQtTaskButton::mimeDataFormat()));
+        stream >> temp;
+        WId window = (WId) temp;
+
+        // get current position of the button being dragged
+        for (int i = 0; i < layout()->count(); i++)
         {
-            button = b;
-            oldIndex = i;
-            break;
+            LXQtTaskButton *b = qobject_cast<LXQtTaskButton*>(layout()->itemAt(i)->widget());
+            if (b && b->windowId() == window)
+            {
+                button = b;
+                oldIndex = i;
+                break;
+            }
         }
     }
 
-    if (button == nullptr)
+    if (button == nullptr || -1 == oldIndex)
         return;
 
     int newIndex = -1;
@@ -183,3 +212,69 @@ void LXQtGroupPopup::timerEvent(QTimerEvent * /*event*/)
     if (!button_has_dnd_hover)
         close();
 }
+
+/************************************************
+ Thumbnails are updated only while the popup is shown
+ ************************************************/
+void LXQtGroupPopup::showEvent(QShowEvent * event)
+{
+    LXQtTaskThumbnailer * const thumbnailer = mGroup->parentTaskBar()->thumbnailer();
+    if (thumbnailer && !mThumbnailConnection)
+    {
+        mThumbnailConnection = connect(thumbnailer, &LXQtTaskThumbnailer::thumbnailChanged, this, [this, thumbnailer] (WId window, QImage const & thumbnail) {
+            for (int i = 0; i < layout()->count(); ++i)
+            {
+                LXQtTaskButton * button = qobject_cast<LXQtTaskButton *>(layout()->itemAt(i)->widget());
+                if (button && button->windowId() == window)
+                {
+                    button->setThumbnail(thumbnail, thumbnailer->thumbnailSize());
+                    break;
+                }
+            }
+        });
+    }
+
+    for (int i = 0; i < layout()->count(); ++i)
+        if (LXQtTaskButton * button = qobject_cast<LXQtTaskButton *>(layout()->itemAt(i)->widget()))
+            watchThumbnail(button);
+
+    QFrame::showEvent(event);
+}
+
+/************************************************
+
+ ************************************************/
+void LXQtGroupPopup::hideEvent(QHideEvent * event)
+{
+    for (int i = 0; i < layout()->count(); ++i)
+        if (LXQtTaskButton * button = qobject_cast<LXQtTaskButton *>(layout()->itemAt(i)->widget()))
+            unwatchThumbnail(button);
+    disconnect(mThumbnailConnection);
+
+    QFrame::hideEvent(event);
+}
+
+/************************************************
+
+ ************************************************/
+void LXQtGroupPopup::watchThumbnail(LXQtTaskButton * button)
+{
+    if (LXQtTaskThumbnailer * const thumbnailer = mGroup->parentTaskBar()->thumbnailer())
+    {
+        // show the cached one until the fresh capture is ready
+        button->setThumbnail(thumbnailer->thumbnail(button->windowId()), thumbnailer->thumbnailSize());
+        thumbnailer->watch(button->windowId());
+    } else
+    {
+        button->setThumbnail(QImage(), QSize());
+    }
+}
+
+/************************************************
+
+ ************************************************/
+void LXQtGroupPopup::unwatchThumbnail(LXQtTaskButton * button)
+{
+    if (LXQtTaskThumbnailer * const thumbnailer = mGroup->parentTaskBar()->thumbnailer())
+        thumbnailer->unwatch(button->windowId());
+}
@@ -57,8 +57,8 @@ public:
     int count() { return layout()->count(); }
     QLayoutItem * itemAt(int i) { return layout()->itemAt(i); }
     int spacing() { return layout()->spacing(); }
-    void addButton(LXQtTaskButton* button) { layout()->addWidget(button); }
-    void removeWidget(QWidget *button) { layout()->removeWidget(button); }
+    void addButton(LXQtTaskButton* button);
+    void removeWidget(QWidget *button);
 
 protected:
     void dragEnterEvent(QDragEnterEvent * event);
@@ -68,12 +68,19 @@ protected:
     void enterEvent(QEvent * event);
     void paintEvent(QPaintEvent * event);
     void timerEvent(QTimerEvent * event);
+    void showEvent(QShowEvent * event);
+    void hideEvent(QHideEvent * event);
+
+private:
+    void watchThumbnail(LXQtTaskButton * button);
+    void unwatchThumbnail(LXQtTaskButton * button);
 
 private:
     LXQtTaskGroup *mGroup;
     int mCloseTimerId;
     int mWindowCount;
     QVBoxLayout mLayout;
+    QMetaObject::Connection mThumbnailConnection;
 };
 
 #endif // LXQTTASKPOPUP_H
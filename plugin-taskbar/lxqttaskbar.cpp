@@ -37,8 +37,14 @@
 #include <QMimeData>
 #include <QWheelEvent>
 #include <QFlag>
-#include <QX11Info>
 #include <QTimer>
+#include <QMenu>
+#include <QDesktopWidget>
+#include <QScreen>
+#include <QPainter>
+#include <QDBusConnection>
+
+#include <algorithm>
 
 #include <lxqt-globalkeys.h>
 #include <LXQt/GridLayout>
@@ -46,13 +52,15 @@
 
 #include "lxqttaskbar.h"
 #include "lxqttaskgroup.h"
+#include "lxqttaskthumbnailer.h"
+#include "lxqttaskbarbackend.h"
 
 using namespace LXQt;
 
 /************************************************
 
 ************************************************/
-LXQtTaskBar::LXQtTaskBar(ILXQtPanelPlugin *plugin, QWidget *parent) :
+LXQtTaskBar::LXQtTaskBar(ILXQtPanelPlugin *plugin, QWidget *parent, LXQtTaskBarBackend *backend) :
     QFrame(parent),
     mSignalMapper(new QSignalMapper(this)),
     mButtonStyle(Qt::ToolButtonTextBesideIcon),
@@ -71,8 +79,24 @@ LXQtTaskBar::LXQtTaskBar(ILXQtPanelPlugin *plugin, QWidget *parent) :
     mIconByClass(false),
     mWheelEventsAction(1),
     mWheelDeltaThreshold(300),
+    mMaxTaskButtons(0),
+    mShowBadges(false),
     mPlugin(plugin),
+    mBackend(backend ? backend : new LXQtTaskBarX11Backend(this)),
     mPlaceHolder(new QWidget(this)),
+    mPageButton(new QToolButton(this)),
+    mPagingTimer(new QTimer(this)),
+    mPage(0),
+    mThumbnailer(nullptr),
+    mVisibilityTimer(new QTimer(this)),
+    mDesktopSwitchBatch(false),
+    mCurrentScreen(-1),
+    mScreenEpoch(0),
+    mWheelDelta(0),
+    mWheelIndex(-1),
+    mWheelTimer(new QTimer(this)),
+    mLayoutIndexDirty(true),
+    mDragMove(-1, -1),
     mStyle(new LeftAlignedTextStyle())
 {
     setStyle(mStyle);
@@ -87,16 +111,50 @@ LXQtTaskBar::LXQtTaskBar(ILXQtPanelPlugin *plugin, QWidget *parent) :
     mPlaceHolder->setSizePolicy(QSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding));
     mLayout->addWidget(mPlaceHolder);
 
+    mPageButton->setObjectName(QStringLiteral("TaskBarPageButton"));
+    mPageButton->setToolButtonStyle(Qt::ToolButtonTextOnly);
+    mPageButton->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+    mPageButton->setMinimumSize(1, 1);
+    mPageButton->hide();
+    mLayout->addWidget(mPageButton);
+    connect(mPageButton, &QToolButton::clicked, this, &LXQtTaskBar::showOverflowMenu);
+
+    mPagingTimer->setSingleShot(true);
+    mPagingTimer->setInterval(0);
+    connect(mPagingTimer, &QTimer::timeout, this, &LXQtTaskBar::refreshPaging);
+
+    mWheelTimer->setSingleShot(true);
+    mWheelTimer->setInterval(150);
+    connect(mWheelTimer, &QTimer::timeout, this, &LXQtTaskBar::activateWheelTarget);
+
+    mVisibilityTimer->setSingleShot(true);
+    connect(mVisibilityTimer, &QTimer::timeout, this, &LXQtTaskBar::refreshPendingVisibility);
+    // the filters decide which groups make the pages
+    connect(this, &LXQtTaskBar::showOnlySettingChanged, this, &LXQtTaskBar::schedulePaging);
+
     QTimer::singleShot(0, this, &LXQtTaskBar::settingsChanged);
     setAcceptDrops(true);
 
     connect(mSignalMapper, &QSignalMapper::mappedInt, this, &LXQtTaskBar::activateTask);
-    QTimer::singleShot(0, this, &LXQtTaskBar::registerShortcuts);
-
-    connect(KWindowSystem::self(), static_cast<void (KWindowSystem::*)(WId, NET::Properties, NET::Properties2)>(&KWindowSystem::windowChanged)
-            , this, &LXQtTaskBar::onWindowChanged);
-    connect(KWindowSystem::self(), &KWindowSystem::windowAdded, this, &LXQtTaskBar::onWindowAdded);
-    connect(KWindowSystem::self(), &KWindowSystem::windowRemoved, this, &LXQtTaskBar::onWindowRemoved);
+    // a taskbar with the custom backend is not the one the user interacts with
+    if (!backend)
+        QTimer::singleShot(0, this, &LXQtTaskBar::registerShortcuts);
+
+    connect(mBackend, &LXQtTaskBarBackend::windowChanged, this, &LXQtTaskBar::onWindowChanged);
+    connect(mBackend, &LXQtTaskBarBackend::windowAdded, this, &LXQtTaskBar::onWindowAdded);
+    connect(mBackend, &LXQtTaskBarBackend::windowRemoved, this, &LXQtTaskBar::onWindowRemoved);
+    connect(mBackend, &LXQtTaskBarBackend::activeWindowChanged, this, &LXQtTaskBar::onActiveWindowChanged);
+    connect(mBackend, &LXQtTaskBarBackend::windowUrgencyChanged, this, &LXQtTaskBar::onWindowUrgencyChanged);
+    connect(mBackend, &LXQtTaskBarBackend::currentDesktopChanged, this, &LXQtTaskBar::onCurrentDesktopChanged);
+
+    const auto screens = QGuiApplication::screens();
+    for (QScreen * screen : screens)
+        connect(screen, &QScreen::geometryChanged, this, &LXQtTaskBar::onScreensChanged);
+    connect(qApp, &QGuiApplication::screenAdded, this, [this] (QScreen * screen) {
+        connect(screen, &QScreen::geometryChanged, this, &LXQtTaskBar::onScreensChanged);
+        onScreensChanged();
+    });
+    connect(qApp, &QGuiApplication::screenRemoved, this, &LXQtTaskBar::onScreensChanged);
 }
 
 /************************************************
@@ -121,29 +179,26 @@ bool LXQtTaskBar::acceptWindow(WId window) const
     ignoreList |= NET::PopupMenuMask;
     ignoreList |= NET::NotificationMask;
 
-    KWindowInfo info(window, NET::WMWindowType | NET::WMState, NET::WM2TransientFor);
-    if (!info.valid())
+    if (!mBackend->isValid(window))
         return false;
 
-    if (NET::typeMatchesMask(info.windowType(NET::AllTypesMask), ignoreList))
+    if (NET::typeMatchesMask(mBackend->windowType(window, NET::AllTypesMask), ignoreList))
         return false;
 
-    if (info.state() & NET::SkipTaskbar)
+    if (mBackend->windowState(window) & NET::SkipTaskbar)
         return false;
 
     // WM_TRANSIENT_FOR hint not set - normal window
-    WId transFor = info.transientFor();
-    if (transFor == 0 || transFor == window || transFor == (WId) QX11Info::appRootWindow())
+    WId transFor = mBackend->transientFor(window);
+    if (transFor == 0 || transFor == window || transFor == mBackend->rootWindow())
         return true;
 
-    info = KWindowInfo(transFor, NET::WMWindowType);
-
     QFlags<NET::WindowTypeMask> normalFlag;
     normalFlag |= NET::NormalMask;
     normalFlag |= NET::DialogMask;
     normalFlag |= NET::UtilityMask;
 
-    return !NET::typeMatchesMask(info.windowType(NET::AllTypesMask), normalFlag);
+    return !NET::typeMatchesMask(mBackend->windowType(transFor, NET::AllTypesMask), normalFlag);
 }
 
 /************************************************
@@ -151,7 +206,7 @@ bool LXQtTaskBar::acceptWindow(WId window) const
  ************************************************/
 void LXQtTaskBar::dragEnterEvent(QDragEnterEvent* event)
 {
-    if (event->mimeData()->hasFormat(LXQtTaskGroup::mimeDataFormat()))
+    if (LXQtTaskButton::isTaskButtonDrag(event))
     {
         event->acceptProposedAction();
         buttonMove(nullptr, qobject_cast<LXQtTaskGroup *>(event->source()), event->pos());
@@ -176,7 +231,7 @@ void LXQtTaskBar::dragMoveEvent(QDragMoveEvent * event)
 void LXQtTaskBar::buttonMove(LXQtTaskGroup * dst, LXQtTaskGroup * src, QPoint const & pos)
 {
     int src_index;
-    if (!src || -1 == (src_index = mLayout->indexOf(src)))
+    if (!src || -1 == (src_index = layoutIndexOf(src)))
     {
         qDebug() << "Dropped invalid";
         return;
@@ -218,8 +273,12 @@ void LXQtTaskBar::buttonMove(LXQtTaskGroup * dst, LXQtTaskGroup * src, QPoint co
     } else
     {
         //moving based on signal from child button
-        dst_index = mLayout->indexOf(dst);
+        dst_index = layoutIndexOf(dst);
+        // the pointer is still over the button it was over when nothing was to be moved
+        if (qMakePair(src_index, dst_index) == mDragMove)
+            return;
     }
+    const QPair<int, int> move{src_index, dst_index};
 
     //moving lower index to higher one => consider as the QList::move => insert(to, takeAt(from))
     if (src_index < dst_index)
@@ -237,12 +296,129 @@ void LXQtTaskBar::buttonMove(LXQtTaskGroup * dst, LXQtTaskGroup * src, QPoint co
         }
     }
 
-    if (dst_index == src_index
-            || mLayout->animatedMoveInProgress()
-       )
+    if (mLayout->animatedMoveInProgress())
+        return;
+
+    if (dst_index == src_index)
+    {
+        if (nullptr != dst)
+            mDragMove = move;
         return;
+    }
 
     mLayout->moveItem(src_index, dst_index, true);
+    invalidateLayoutIndex();
+    // the order of buttons defines the pages
+    if (isPaged())
+        syncGroupOrder();
+    schedulePaging();
+}
+
+/************************************************
+
+ ************************************************/
+int LXQtTaskBar::layoutIndexOf(LXQtTaskGroup * group)
+{
+    if (mLayoutIndexDirty)
+    {
+        mLayoutIndex.clear();
+        for (int i = 0, i_e = mLayout->count(); i < i_e; ++i)
+            if (LXQtTaskGroup * g = qobject_cast<LXQtTaskGroup *>(mLayout->itemAt(i)->widget()))
+                mLayoutIndex.insert(g, i);
+        mLayoutIndexDirty = false;
+    }
+    return mLayoutIndex.value(group, -1);
+}
+
+/************************************************
+
+ ************************************************/
+void LXQtTaskBar::dragFinished()
+{
+    mDragMove = qMakePair(-1, -1);
+    // the paging waits for the drag (the dragged group mustn't be deleted)
+    if (isPaged())
+        schedulePaging();
+}
+
+/************************************************
+
+ ************************************************/
+QPixmap LXQtTaskBar::badgePixmap(int count, int size, qreal devicePixelRatio)
+{
+    // the same badge for all the big numbers
+    count = qBound(0, count, 100);
+    const quint64 key = static_cast<quint64>(count)
+        | static_cast<quint64>(size) << 8
+        | static_cast<quint64>(qRound(devicePixelRatio * 100)) << 32;
+    auto i = mBadgeCache.constFind(key);
+    if (mBadgeCache.cend() != i)
+        return *i;
+
+    const QString text = 100 > count ? QString::number(count) : QStringLiteral("99+");
+    QFont f = font();
+    f.setBold(true);
+    f.setPixelSize(qMax(6, size * 2 / 3));
+    const int width = qMax(size, QFontMetrics{f}.horizontalAdvance(text) + size / 2);
+
+    QPixmap badge{QSize{width, size} * devicePixelRatio};
+    badge.setDevicePixelRatio(devicePixelRatio);
+    badge.fill(Qt::transparent);
+    QPainter painter{&badge};
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(palette().color(QPalette::Highlight));
+    painter.drawRoundedRect(QRectF{0, 0, static_cast<qreal>(width), static_cast<qreal>(size)}, size / 2.0, size / 2.0);
+    painter.setPen(palette().color(QPalette::HighlightedText));
+    painter.setFont(f);
+    painter.drawText(QRect{0, 0, width, size}, Qt::AlignCenter, text);
+    painter.end();
+
+    mBadgeCache.insert(key, badge);
+    return badge;
+}
+
+/************************************************
+
+ ************************************************/
+QString LXQtTaskBar::launcherAppId(QString const & id)
+{
+    // e.g. "org.kde.dolphin" (desktop file) vs. "dolphin" (window class)
+    return id.section(QLatin1Char('.'), -1).toLower();
+}
+
+/************************************************
+
+ ************************************************/
+void LXQtTaskBar::onLauncherEntryUpdate(QString const & appUri, QVariantMap const & properties)
+{
+    QString id = appUri;
+    if (id.startsWith(QLatin1String("application://")))
+        id.remove(0, 14);
+    if (id.endsWith(QLatin1String(".desktop")))
+        id.chop(8);
+    id = launcherAppId(id);
+
+    const double progress_old = mLauncherProgress.value(id, -1.0);
+    double progress = progress_old;
+    if (properties.contains(QStringLiteral("progress-visible")) && !properties.value(QStringLiteral("progress-visible")).toBool())
+        progress = -1.0;
+    else if (properties.contains(QStringLiteral("progress")))
+        progress = qBound(0.0, properties.value(QStringLiteral("progress")).toDouble(), 1.0);
+
+    if (progress == progress_old)
+        return;
+    if (0 > progress)
+        mLauncherProgress.remove(id);
+    else
+        mLauncherProgress.insert(id, progress);
+
+    for (int i = 0, i_e = mLayout->count(); i < i_e; ++i)
+    {
+        LXQtTaskGroup * group = qobject_cast<LXQtTaskGroup *>(mLayout->itemAt(i)->widget());
+        if (group && group->appId() == id)
+            group->update();
+    }
 }
 
 /************************************************
@@ -261,8 +437,112 @@ void LXQtTaskBar::groupBecomeEmptySlot()
         else
             ++i;
     }
+    auto materialized = mMaterialized.find(group->groupName());
+    if (mMaterialized.end() != materialized && group == *materialized)
+        mMaterialized.erase(materialized);
     mLayout->removeWidget(group);
+    invalidateLayoutIndex();
+    mPendingVisibility.remove(group);
     group->deleteLater();
+    schedulePaging();
+}
+
+/************************************************
+
+ ************************************************/
+void LXQtTaskBar::requestRefreshVisibility(LXQtTaskGroup * group)
+{
+    mPendingVisibility.insert(group, group);
+    // in the middle of a burst the timer is running already
+    if (!mVisibilityTimer->isActive())
+        mVisibilityTimer->start(0);
+}
+
+/************************************************
+
+ ************************************************/
+void LXQtTaskBar::onCurrentDesktopChanged()
+{
+    for (auto i = mKnownWindows.cbegin(), i_e = mKnownWindows.cend(); i != i_e; ++i)
+        mPendingVisibility.insert(*i, *i);
+    if (isPaged() && mShowOnlyOneDesktopTasks && 0 == mShowDesktopNum)
+        schedulePaging();
+    // the desktop switch is followed by a burst of WMDesktop/WMState changes
+    // of the windows, wait a bit for them to apply everything in one pass
+    mDesktopSwitchBatch = true;
+    mVisibilityTimer->start(30);
+}
+
+/************************************************
+
+ ************************************************/
+void LXQtTaskBar::refreshScreens()
+{
+    mCurrentScreen = QApplication::desktop()->screenNumber(this);
+    // invalidate the screens cached by buttons
+    ++mScreenEpoch;
+}
+
+/************************************************
+
+ ************************************************/
+void LXQtTaskBar::onScreensChanged()
+{
+    refreshScreens();
+    if (mShowOnlyCurrentScreenTasks)
+        emit showOnlySettingChanged();
+}
+
+/************************************************
+
+ ************************************************/
+void LXQtTaskBar::refreshPendingVisibility()
+{
+    mVisibilityTimer->stop();
+    // just the desktop switch (many groups at once) is worth holding the repaints
+    const bool batch = mDesktopSwitchBatch;
+    mDesktopSwitchBatch = false;
+    if (mPendingVisibility.isEmpty())
+        return;
+
+    if (batch)
+    {
+        setUpdatesEnabled(false);
+        mLayout->setEnabled(false);
+    }
+
+    const auto groups = mPendingVisibility;
+    mPendingVisibility.clear();
+    bool toggled = false;
+    for (LXQtTaskGroup * group : groups)
+        if (group)
+            toggled |= group->refreshVisibility();
+    // apply the paging in the same pass (if any group changed its visibility)
+    if (mPagingTimer->isActive())
+        refreshPaging();
+
+    if (batch)
+    {
+        mLayout->setEnabled(true);
+        setUpdatesEnabled(true);
+    }
+    // the layout changes only with some group shown/hidden
+    if (toggled)
+        mLayout->invalidate();
+}
+
+/************************************************
+
+ ************************************************/
+void LXQtTaskBar::flushPendingWork()
+{
+    refreshPendingVisibility();
+    if (mPagingTimer->isActive())
+        refreshPaging();
+
+    const auto buttons = findChildren<LXQtTaskButton *>();
+    for (LXQtTaskButton * button : buttons)
+        button->flushText();
 }
 
 /************************************************
@@ -271,7 +551,7 @@ void LXQtTaskBar::groupBecomeEmptySlot()
 void LXQtTaskBar::addWindow(WId window)
 {
     // If grouping disabled group behaves like regular button
-    const QString group_id = mGroupingEnabled ? QString::fromUtf8(KWindowInfo(window, NET::Properties(), NET::WM2WindowClass).windowClassClass()) : QString::number(window);
+    const QString group_id = mGroupingEnabled ? QString::fromUtf8(mBackend->windowClass(window)) : QString::number(window);
 
     LXQtTaskGroup *group = nullptr;
     auto i_group = mKnownWindows.find(window);
@@ -298,19 +578,11 @@ void LXQtTaskBar::addWindow(WId window)
 
     if (!group)
     {
-        group = new LXQtTaskGroup(group_id, window, this);
-        connect(group, &LXQtTaskGroup::groupBecomeEmpty,  this, &LXQtTaskBar::groupBecomeEmptySlot);
-        connect(group, &LXQtTaskGroup::visibilityChanged, this, &LXQtTaskBar::refreshPlaceholderVisibility);
-        connect(group, &LXQtTaskGroup::popupShown,        this, &LXQtTaskBar::popupShown);
-        connect(group, &LXQtTaskButton::dragging,         this, [this] (QObject * dragSource, QPoint const & pos) {
-            buttonMove(qobject_cast<LXQtTaskGroup *>(sender()), qobject_cast<LXQtTaskGroup *>(dragSource), pos);
-        });
-        mLayout->addWidget(group);
-        group->setToolButtonsStyle(mButtonStyle);
+        group = createGroup(group_id, window);
 
         if (mUngroupedNextToExisting)
         {
-            const QString window_class = QString::fromUtf8(KWindowInfo(window, NET::Properties(), NET::WM2WindowClass).windowClassClass());
+            const QString window_class = QString::fromUtf8(mBackend->windowClass(window));
             int src_index = mLayout->count() - 1;
             int dst_index = src_index;
             for (int i = mLayout->count() - 2; 0 <= i; --i)
@@ -318,7 +590,7 @@ void LXQtTaskBar::addWindow(WId window)
                 LXQtTaskGroup * current_group = qobject_cast<LXQtTaskGroup*>(mLayout->itemAt(i)->widget());
                 if (nullptr != current_group)
                 {
-                    const QString current_class = QString::fromUtf8(KWindowInfo((current_group->groupName()).toUInt(), NET::Properties(), NET::WM2WindowClass).windowClassClass());
+                    const QString current_class = QString::fromUtf8(mBackend->windowClass((current_group->groupName()).toUInt()));
                     if(current_class == window_class)
                     {
                         dst_index = i + 1;
@@ -330,6 +602,7 @@ void LXQtTaskBar::addWindow(WId window)
             if (dst_index != src_index)
             {
                 mLayout->moveItem(src_index, dst_index, false);
+                invalidateLayoutIndex();
             }
         }
     }
@@ -337,6 +610,24 @@ void LXQtTaskBar::addWindow(WId window)
     group->addWindow(window);
 }
 
+/************************************************
+
+ ************************************************/
+LXQtTaskGroup * LXQtTaskBar::createGroup(QString const & id, WId window)
+{
+    LXQtTaskGroup * group = new LXQtTaskGroup(id, window, this);
+    connect(group, &LXQtTaskGroup::groupBecomeEmpty,  this, &LXQtTaskBar::groupBecomeEmptySlot);
+    connect(group, &LXQtTaskGroup::visibilityChanged, this, &LXQtTaskBar::schedulePaging);
+    connect(group, &LXQtTaskGroup::popupShown,        this, &LXQtTaskBar::popupShown);
+    connect(group, &LXQtTaskButton::dragging,         this, [this] (QObject * dragSource, QPoint const & pos) {
+        buttonMove(qobject_cast<LXQtTaskGroup *>(sender()), qobject_cast<LXQtTaskGroup *>(dragSource), pos);
+    });
+    mLayout->addWidget(group);
+    invalidateLayoutIndex();
+    group->setToolButtonsStyle(mButtonStyle);
+    return group;
+}
+
 /************************************************
 
  ************************************************/
@@ -346,6 +637,8 @@ auto LXQtTaskBar::removeWindow(windowMap_t::iterator pos) -> windowMap_t::iterat
     LXQtTaskGroup * const group = *pos;
     auto ret = mKnownWindows.erase(pos);
     group->onWindowRemoved(window);
+    if (mThumbnailer)
+        mThumbnailer->forget(window);
     return ret;
 }
 
@@ -356,17 +649,27 @@ void LXQtTaskBar::refreshTaskList()
 {
     QList<WId> new_list;
     // Just add new windows to groups, deleting is up to the groups
-    const auto wnds = KWindowSystem::stackingOrder();
+    const auto wnds = mBackend->stackingOrder();
     for (auto const wnd: wnds)
     {
         if (acceptWindow(wnd))
         {
             new_list << wnd;
-            addWindow(wnd);
+            if (isPaged())
+                addRecord(wnd);
+            else
+                addWindow(wnd);
         }
     }
 
     //emulate windowRemoved if known window not reported by KWindowSystem
+    if (isPaged())
+    {
+        const auto records = mRecords.keys();
+        for (WId const wnd : records)
+            if (0 > new_list.indexOf(wnd))
+                removeRecord(wnd);
+    }
     for (auto i = mKnownWindows.begin(), i_e = mKnownWindows.end(); i != i_e; )
     {
         if (0 > new_list.indexOf(i.key()))
@@ -384,18 +687,97 @@ void LXQtTaskBar::refreshTaskList()
  ************************************************/
 void LXQtTaskBar::onWindowChanged(WId window, NET::Properties prop, NET::Properties2 prop2)
 {
+    if (isPaged())
+    {
+        auto record = mRecords.find(window);
+        if (mRecords.end() == record)
+            return;
+
+        bool filtered = false;
+        if (prop.testFlag(NET::WMState) || prop.testFlag(NET::XAWMState))
+        {
+            if (mBackend->windowState(window).testFlag(NET::SkipTaskbar))
+            {
+                removeRecord(window);
+                return;
+            }
+            const bool minimized = mBackend->isMinimized(window);
+            filtered |= mShowOnlyMinimizedTasks && minimized != record->minimized;
+            record->minimized = minimized;
+        }
+        if (prop2.testFlag(NET::WM2WindowClass))
+        {
+            const QByteArray windowClass = mBackend->windowClass(window);
+            if (mGroupingEnabled && windowClass != record->windowClass)
+            {
+                // the window moves to another group
+                removeRecord(window);
+                if (acceptWindow(window))
+                    addRecord(window);
+                return;
+            }
+            record->windowClass = windowClass;
+        }
+        if (prop.testFlag(NET::WMDesktop))
+        {
+            const int desktop = mBackend->windowDesktop(window);
+            filtered |= mShowOnlyOneDesktopTasks && desktop != record->desktop;
+            record->desktop = desktop;
+        }
+        if (prop.testFlag(NET::WMGeometry))
+        {
+            // (found out lazily while the filter is off)
+            record->screenEpoch = -1;
+            if (mShowOnlyCurrentScreenTasks)
+            {
+                const quint32 mask = LXQtTaskButton::screenMask(mBackend->frameGeometry(window));
+                filtered |= mask != record->screenMask;
+                record->screenMask = mask;
+                record->screenEpoch = mScreenEpoch;
+            }
+        }
+        if (filtered)
+            schedulePaging();
+        // the windows of other pages have no widgets to update
+        if (!mKnownWindows.contains(window))
+            return;
+    }
+
     auto i = mKnownWindows.find(window);
     if (mKnownWindows.end() != i)
     {
-        if (!(*i)->onWindowChanged(window, prop, prop2) && acceptWindow(window))
+        if (!(*i)->onWindowChanged(window, prop, prop2) && !isPaged() && acceptWindow(window))
         { // window is removed from a group because of class change, so we should add it again
             addWindow(window);
         }
     }
 }
 
+/************************************************
+
+ ************************************************/
+void LXQtTaskBar::onWindowUrgencyChanged(WId window, bool urgent)
+{
+    auto record = mRecords.find(window);
+    if (mRecords.end() != record)
+        record->urgent = urgent;
+    auto i = mKnownWindows.constFind(window);
+    if (mKnownWindows.cend() != i)
+        (*i)->setUrgencyHint(window, urgent);
+}
+
+/************************************************
+
+ ************************************************/
 void LXQtTaskBar::onWindowAdded(WId window)
 {
+    if (isPaged())
+    {
+        if (!mRecords.contains(window) && acceptWindow(window))
+            addRecord(window);
+        return;
+    }
+
     auto const pos = mKnownWindows.find(window);
     if (mKnownWindows.end() == pos && acceptWindow(window))
         addWindow(window);
@@ -406,6 +788,12 @@ void LXQtTaskBar::onWindowAdded(WId window)
  ************************************************/
 void LXQtTaskBar::onWindowRemoved(WId window)
 {
+    if (isPaged())
+    {
+        removeRecord(window);
+        return;
+    }
+
     auto const pos = mKnownWindows.find(window);
     if (mKnownWindows.end() != pos)
     {
@@ -430,10 +818,11 @@ void LXQtTaskBar::refreshButtonRotation()
 void LXQtTaskBar::refreshPlaceholderVisibility()
 {
     // if no visible group button show placeholder widget
-    bool haveVisibleWindow = false;
-    for (auto i = mKnownWindows.cbegin(), i_e = mKnownWindows.cend(); i_e != i; ++i)
+    // (in the paged mode just the groups passing the filters are materialized)
+    bool haveVisibleWindow = isPaged() && !mMaterialized.isEmpty();
+    for (auto i = mKnownWindows.cbegin(), i_e = mKnownWindows.cend(); i_e != i && !haveVisibleWindow; ++i)
     {
-        if ((*i)->isVisible())
+        if ((*i)->isShownByFilter())
         {
             haveVisibleWindow = true;
             break;
@@ -447,7 +836,348 @@ void LXQtTaskBar::refreshPlaceholderVisibility()
         mPlaceHolder->setMinimumSize(1, 1);
         mPlaceHolder->setMaximumSize(QWIDGETSIZE_MAX, QWIDGETSIZE_MAX);
     }
+}
+
+/************************************************
 
+ ************************************************/
+void LXQtTaskBar::schedulePaging()
+{
+    if (!mPagingTimer->isActive())
+        mPagingTimer->start();
+}
+
+/************************************************
+ Splits the groups passing the filters into pages of mMaxTaskButtons.
+ Only the groups of the current page exist as widgets, the others are
+ just the records of their windows.
+ ************************************************/
+void LXQtTaskBar::refreshPaging()
+{
+    mPagingTimer->stop();
+    if (!isPaged())
+    {
+        mPageButton->hide();
+        refreshPlaceholderVisibility();
+        return;
+    }
+    // the dragged group mustn't be deleted, dragFinished() comes back here
+    if (LXQtTaskButton::isDragging())
+        return;
+
+    // groups passing the "show only" filters (in the taskbar order)
+    QStringList shown;
+    for (QString const & id : qAsConst(mGroupOrder))
+        if (isGroupShown(id))
+            shown << id;
+
+    const int pages = qMax(1, (shown.count() + mMaxTaskButtons - 1) / mMaxTaskButtons);
+    mPage = qBound(0, mPage, pages - 1);
+    const QStringList page = shown.mid(mPage * mMaxTaskButtons, mMaxTaskButtons);
+
+    setUpdatesEnabled(false);
+    for (auto i = mMaterialized.begin(); mMaterialized.end() != i; )
+    {
+        if (page.contains(i.key()))
+        {
+            ++i;
+            continue;
+        }
+        LXQtTaskGroup * const group = *i;
+        i = mMaterialized.erase(i);
+        dematerialize(group);
+    }
+    // the groups entering the page are created, all placed in the page order
+    // (the placeholder and the page button precede the groups)
+    const int first = mLayout->indexOf(mPageButton) + 1;
+    for (int i = 0, i_e = page.count(); i < i_e; ++i)
+    {
+        if (!mMaterialized.contains(page[i]))
+            materialize(page[i]);
+        const int index = mLayout->indexOf(mMaterialized.value(page[i]));
+        if (index != first + i)
+        {
+            mLayout->moveItem(index, first + i, false);
+            invalidateLayoutIndex();
+        }
+    }
+    setUpdatesEnabled(true);
+    // (the new groups announced their visibility)
+    mPagingTimer->stop();
+
+    mPageButton->setVisible(1 < pages);
+    if (1 < pages)
+    {
+        int others = 0;
+        for (QString const & id : qAsConst(shown))
+            if (!mMaterialized.contains(id))
+                others += mGroupWindows.value(id).count();
+        mPageButton->setText(QStringLiteral("%1/%2").arg(mPage + 1).arg(pages));
+        mPageButton->setToolTip(tr("%n window(s) on other pages", nullptr, others));
+    }
+
+    refreshPlaceholderVisibility();
+}
+
+/************************************************
+
+ ************************************************/
+void LXQtTaskBar::showGroupPage(QString const & id)
+{
+    if (!isPaged() || mMaterialized.contains(id) || !isGroupShown(id))
+        return;
+
+    int index = 0;
+    for (QString const & g : qAsConst(mGroupOrder))
+    {
+        if (g == id)
+            break;
+        if (isGroupShown(g))
+            ++index;
+    }
+    mPage = index / mMaxTaskButtons;
+    refreshPaging();
+}
+
+/************************************************
+
+ ************************************************/
+void LXQtTaskBar::showOverflowMenu()
+{
+    QMenu * menu = new QMenu(this);
+    menu->setAttribute(Qt::WA_DeleteOnClose);
+    const int iconSize = mPlugin->panel()->iconSize();
+    for (QString const & id : qAsConst(mGroupOrder))
+    {
+        if (mMaterialized.contains(id) || !isGroupShown(id))
+            continue;
+
+        const QVector<WId> windows = mGroupWindows.value(id);
+        const WId window = windows.first();
+        const QString text = 1 == windows.count() ? mBackend->windowTitle(window)
+            : QStringLiteral("%1 - %2 windows").arg(id).arg(windows.count());
+        QAction * a = menu->addAction(QIcon{mBackend->windowIcon(window, iconSize)}, text);
+        connect(a, &QAction::triggered, this, [this, id] {
+            showGroupPage(id);
+            LXQtTaskGroup * group = mMaterialized.value(id);
+            if (group && 1 == group->visibleButtonsCount())
+                group->raiseApplication();
+        });
+    }
+
+    menu->setGeometry(mPlugin->panel()->calculatePopupWindowPos(mapToGlobal(mPageButton->pos()), menu->sizeHint()));
+    mPlugin->willShowWindow(menu);
+    menu->show();
+}
+
+/************************************************
+
+ ************************************************/
+void LXQtTaskBar::onActiveWindowChanged(WId window)
+{
+    // make sure the button of the activated window is reachable
+    auto record = mRecords.constFind(window);
+    if (mRecords.cend() != record)
+        showGroupPage(record->group);
+}
+
+/************************************************
+
+ ************************************************/
+void LXQtTaskBar::addRecord(WId window)
+{
+    const QByteArray windowClass = mBackend->windowClass(window);
+    // If grouping disabled group behaves like regular button
+    const QString id = mGroupingEnabled ? QString::fromUtf8(windowClass) : QString::number(window);
+    auto known = mRecords.constFind(window);
+    if (mRecords.cend() != known)
+    {
+        if (known->group == id)
+            return;
+        removeRecord(window);
+    }
+
+    LXQtTaskRecord record;
+    record.group = id;
+    record.windowClass = windowClass;
+    record.desktop = mBackend->windowDesktop(window);
+    record.minimized = mBackend->isMinimized(window);
+    mRecords.insert(window, record);
+
+    QVector<WId> & windows = mGroupWindows[id];
+    if (windows.isEmpty())
+    {
+        int pos = mGroupOrder.count();
+        if (mUngroupedNextToExisting)
+        {
+            for (int i = mGroupOrder.count() - 1; 0 <= i; --i)
+            {
+                const QVector<WId> others = mGroupWindows.value(mGroupOrder[i]);
+                if (!others.isEmpty() && mRecords.value(others.first()).windowClass == windowClass)
+                {
+                    pos = i + 1;
+                    break;
+                }
+            }
+        }
+        mGroupOrder.insert(pos, id);
+    }
+    windows.append(window);
+
+    if (LXQtTaskGroup * group = mMaterialized.value(id))
+    {
+        mKnownWindows[window] = group;
+        group->addWindow(window);
+    }
+    schedulePaging();
+}
+
+/************************************************
+
+ ************************************************/
+void LXQtTaskBar::removeRecord(WId window)
+{
+    auto record = mRecords.find(window);
+    if (mRecords.end() == record)
+        return;
+
+    const QString id = record->group;
+    mRecords.erase(record);
+    auto windows = mGroupWindows.find(id);
+    windows->removeOne(window);
+    if (windows->isEmpty())
+    {
+        mGroupWindows.erase(windows);
+        mGroupOrder.removeOne(id);
+    }
+
+    auto known = mKnownWindows.find(window);
+    if (mKnownWindows.end() != known)
+        removeWindow(known);
+    else if (mThumbnailer)
+        mThumbnailer->forget(window);
+    schedulePaging();
+}
+
+/************************************************
+
+ ************************************************/
+bool LXQtTaskBar::isShownByFilters(WId window, LXQtTaskRecord & record) const
+{
+    if (mShowOnlyOneDesktopTasks)
+    {
+        const int desktop = 0 == mShowDesktopNum ? mBackend->currentDesktop() : mShowDesktopNum;
+        if (NET::OnAllDesktops != record.desktop && desktop != record.desktop)
+            return false;
+    }
+    if (mShowOnlyCurrentScreenTasks)
+    {
+        // the screen layout changed since the last check
+        if (record.screenEpoch != mScreenEpoch)
+        {
+            record.screenMask = LXQtTaskButton::screenMask(mBackend->frameGeometry(window));
+            record.screenEpoch = mScreenEpoch;
+        }
+        if (0 > mCurrentScreen || 32 <= mCurrentScreen || !(record.screenMask & (1u << mCurrentScreen)))
+            return false;
+    }
+    return !mShowOnlyMinimizedTasks || record.minimized;
+}
+
+/************************************************
+
+ ************************************************/
+bool LXQtTaskBar::isGroupShown(QString const & id)
+{
+    const QVector<WId> windows = mGroupWindows.value(id);
+    for (WId const window : windows)
+    {
+        auto record = mRecords.find(window);
+        if (mRecords.end() != record && isShownByFilters(window, *record))
+            return true;
+    }
+    return false;
+}
+
+/************************************************
+
+ ************************************************/
+void LXQtTaskBar::materialize(QString const & id)
+{
+    const QVector<WId> windows = mGroupWindows.value(id);
+    LXQtTaskGroup * group = createGroup(id, windows.first());
+    mMaterialized.insert(id, group);
+    for (WId const window : windows)
+    {
+        mKnownWindows[window] = group;
+        group->addWindow(window);
+        if (mRecords.value(window).urgent)
+            group->setUrgencyHint(window, true);
+    }
+}
+
+/************************************************
+
+ ************************************************/
+void LXQtTaskBar::dematerialize(LXQtTaskGroup * group)
+{
+    for (auto i = mKnownWindows.begin(); mKnownWindows.end() != i; )
+    {
+        if (group == *i)
+            i = mKnownWindows.erase(i);
+        else
+            ++i;
+    }
+    mLayout->removeWidget(group);
+    invalidateLayoutIndex();
+    mPendingVisibility.remove(group);
+    group->deleteLater();
+}
+
+/************************************************
+ The groups of the page were reordered (in the layout), the order
+ of all the groups follows.
+ ************************************************/
+void LXQtTaskBar::syncGroupOrder()
+{
+    QStringList ids;
+    QVector<int> positions;
+    for (int i = 0, i_e = mLayout->count(); i < i_e; ++i)
+    {
+        LXQtTaskGroup * group = qobject_cast<LXQtTaskGroup *>(mLayout->itemAt(i)->widget());
+        const int pos = group ? mGroupOrder.indexOf(group->groupName()) : -1;
+        if (0 <= pos)
+        {
+            ids << group->groupName();
+            positions << pos;
+        }
+    }
+    std::sort(positions.begin(), positions.end());
+    for (int i = 0, i_e = ids.count(); i < i_e; ++i)
+        mGroupOrder[positions[i]] = ids[i];
+}
+
+/************************************************
+
+ ************************************************/
+void LXQtTaskBar::clearGroups()
+{
+    for (int i = mLayout->count() - 1; 0 <= i; --i)
+    {
+        LXQtTaskGroup * group = qobject_cast<LXQtTaskGroup*>(mLayout->itemAt(i)->widget());
+        if (nullptr != group)
+        {
+            mLayout->takeAt(i);
+            invalidateLayoutIndex();
+            mPendingVisibility.remove(group);
+            group->deleteLater();
+        }
+    }
+    mKnownWindows.clear();
+    mRecords.clear();
+    mGroupWindows.clear();
+    mGroupOrder.clear();
+    mMaterialized.clear();
 }
 
 /************************************************
@@ -473,6 +1203,7 @@ void LXQtTaskBar::settingsChanged()
     bool showOnlyCurrentScreenTasksOld = mShowOnlyCurrentScreenTasks;
     bool showOnlyMinimizedTasksOld = mShowOnlyMinimizedTasks;
     const bool iconByClassOld = mIconByClass;
+    const int maxTaskButtonsOld = mMaxTaskButtons;
 
     mButtonWidth = mPlugin->settings()->value(QStringLiteral("buttonWidth"), 400).toInt();
     mButtonHeight = mPlugin->settings()->value(QStringLiteral("buttonHeight"), 100).toInt();
@@ -498,22 +1229,45 @@ void LXQtTaskBar::settingsChanged()
     mIconByClass = mPlugin->settings()->value(QStringLiteral("iconByClass"), false).toBool();
     mWheelEventsAction = mPlugin->settings()->value(QStringLiteral("wheelEventsAction"), 1).toInt();
     mWheelDeltaThreshold = mPlugin->settings()->value(QStringLiteral("wheelDeltaThreshold"), 300).toInt();
+    mMaxTaskButtons = qMax(0, mPlugin->settings()->value(QStringLiteral("maxTaskButtons"), 0).toInt());
 
-    // Delete all groups if grouping or ungrouped next to existing feature toggled and start over
-    if (groupingEnabledOld != mGroupingEnabled || ungroupedNextToExistingOld != mUngroupedNextToExisting)
+    // the progress is announced by the applications through the (Unity) launcher API
+    const bool showBadgesOld = mShowBadges;
+    mShowBadges = mPlugin->settings()->value(QStringLiteral("showBadges"), false).toBool();
+    if (mShowBadges != showBadgesOld)
     {
-        for (int i = mLayout->count() - 1; 0 <= i; --i)
+        const QString interface = QStringLiteral("com.canonical.Unity.LauncherEntry");
+        const QString signal = QStringLiteral("Update");
+        if (mShowBadges)
+            QDBusConnection::sessionBus().connect(QString{}, QString{}, interface, signal
+                    , this, SLOT(onLauncherEntryUpdate(QString,QVariantMap)));
+        else
         {
-            LXQtTaskGroup * group = qobject_cast<LXQtTaskGroup*>(mLayout->itemAt(i)->widget());
-            if (nullptr != group)
-            {
-                mLayout->takeAt(i);
-                group->deleteLater();
-            }
+            QDBusConnection::sessionBus().disconnect(QString{}, QString{}, interface, signal
+                    , this, SLOT(onLauncherEntryUpdate(QString,QVariantMap)));
+            mLauncherProgress.clear();
         }
-        mKnownWindows.clear();
+        mBadgeCache.clear();
+        update();
     }
 
+    // the thumbnailer lives only while thumbnails are enabled
+    const bool showThumbnails = mPlugin->settings()->value(QStringLiteral("showThumbnails"), false).toBool();
+    if (showThumbnails && !mThumbnailer)
+    {
+        mThumbnailer = new LXQtTaskThumbnailer(this);
+    } else if (!showThumbnails && mThumbnailer)
+    {
+        delete mThumbnailer;
+        mThumbnailer = nullptr;
+    }
+
+    // Delete all groups if grouping or ungrouped next to existing feature toggled
+    // (or the paged mode switched) and start over
+    if (groupingEnabledOld != mGroupingEnabled || ungroupedNextToExistingOld != mUngroupedNextToExisting
+            || (0 < maxTaskButtonsOld) != isPaged())
+        clearGroups();
+
     if (showOnlyOneDesktopTasksOld != mShowOnlyOneDesktopTasks
             || (mShowOnlyOneDesktopTasks && showDesktopNumOld != mShowDesktopNum)
             || showOnlyCurrentScreenTasksOld != mShowOnlyCurrentScreenTasks
@@ -522,6 +1276,8 @@ void LXQtTaskBar::settingsChanged()
         emit showOnlySettingChanged();
     if (iconByClassOld != mIconByClass)
         emit iconByClassChanged();
+    if (maxTaskButtonsOld != mMaxTaskButtons)
+        schedulePaging();
 
     refreshTaskList();
 }
@@ -579,6 +1335,7 @@ void LXQtTaskBar::realign()
     mLayout->setEnabled(true);
 
     //our placement on screen could have been changed
+    refreshScreens();
     emit showOnlySettingChanged();
     emit refreshIconGeometry();
 }
@@ -588,58 +1345,91 @@ void LXQtTaskBar::realign()
  ************************************************/
 void LXQtTaskBar::wheelEvent(QWheelEvent* event)
 {
+    if (mPageButton->isVisible() && mPageButton->geometry().contains(event->position().toPoint()))
+    {
+        // scrolling over the page button switches the pages
+        const QPoint angleDelta = event->angleDelta();
+        const int delta = qAbs(angleDelta.x()) > qAbs(angleDelta.y()) ? angleDelta.x() : angleDelta.y();
+        if (0 != delta)
+        {
+            mPage += delta < 0 ? 1 : -1;
+            refreshPaging();
+        }
+        return;
+    }
+
     // ignore wheel action unless user preference is "cycle windows"
     if (mWheelEventsAction != 1)
         return QFrame::wheelEvent(event);
 
-    static int threshold = 0;
-
     QPoint angleDelta = event->angleDelta();
     Qt::Orientation orient = (qAbs(angleDelta.x()) > qAbs(angleDelta.y()) ? Qt::Horizontal : Qt::Vertical);
     int delta = (orient == Qt::Horizontal ? angleDelta.x() : angleDelta.y());
+    if (0 == delta)
+        return QFrame::wheelEvent(event);
 
-    threshold += abs(delta);
-    if (threshold < mWheelDeltaThreshold)
+    // the steps of one wheel gesture are made on the cached list, only
+    // the final target is activated (after the wheel stops); every event
+    // (even below the threshold) keeps the gesture running
+    if (!mWheelTimer->isActive())
+        startWheelCycling();
+    mWheelTimer->start();
+    if (mWheelButtons.isEmpty())
         return QFrame::wheelEvent(event);
-    else
-        threshold = 0;
 
-    int D = delta < 0 ? 1 : -1;
+    mWheelDelta += abs(delta);
+    const int threshold = qMax(1, mWheelDeltaThreshold);
+    const int steps = mWheelDelta / threshold;
+    mWheelDelta %= threshold;
+    if (0 < steps)
+    {
+        const int count = mWheelButtons.count();
+        const int D = delta < 0 ? 1 : -1;
+        // no active window -> start from the first (or the last) one
+        if (0 > mWheelIndex)
+            mWheelIndex = 0 < D ? -1 : count;
+        mWheelIndex = ((mWheelIndex + D * steps) % count + count) % count;
+    }
+    QFrame::wheelEvent(event);
+}
+
+/************************************************
 
-    // create temporary list of visible groups in the same order like on the layout
-    QList<LXQtTaskGroup*> list;
-    LXQtTaskGroup *group = nullptr;
+ ************************************************/
+void LXQtTaskBar::startWheelCycling()
+{
+    mWheelButtons.clear();
+    mWheelIndex = -1;
+    const WId active = mBackend->activeWindow();
     for (int i = 0; i < mLayout->count(); i++)
     {
-        QWidget * o = mLayout->itemAt(i)->widget();
-        LXQtTaskGroup * g = qobject_cast<LXQtTaskGroup *>(o);
-        if (!g)
+        LXQtTaskGroup * group = qobject_cast<LXQtTaskGroup *>(mLayout->itemAt(i)->widget());
+        if (!group || !group->isVisible())
             continue;
 
-        if (g->isVisible())
-            list.append(g);
-        if (g->isChecked())
-            group = g;
+        const auto buttons = group->visibleChildButtons();
+        for (LXQtTaskButton * button : buttons)
+        {
+            if (button->windowId() == active)
+                mWheelIndex = mWheelButtons.count();
+            mWheelButtons.append(button);
+        }
     }
+}
 
-    if (list.isEmpty())
-        return QFrame::wheelEvent(event);
-
-    if (!group)
-        group = list.at(0);
-
-    LXQtTaskButton *button = nullptr;
+/************************************************
 
-    // switching between groups from temporary list in modulo addressing
-    while (!button)
+ ************************************************/
+void LXQtTaskBar::activateWheelTarget()
+{
+    if (0 <= mWheelIndex && mWheelIndex < mWheelButtons.count())
     {
-        button = group->getNextPrevChildButton(D == 1, !(list.count() - 1));
-        if (button)
+        LXQtTaskButton * const button = mWheelButtons.at(mWheelIndex);
+        if (button && button->windowId() != mBackend->activeWindow())
             button->raiseApplication();
-        int idx = (list.indexOf(group) + D + list.count()) % list.count();
-        group = list.at(idx);
     }
-    QFrame::wheelEvent(event);
+    mWheelButtons.clear();
+    mWheelIndex = -1;
 }
 
 /************************************************
@@ -661,6 +1451,12 @@ void LXQtTaskBar::changeEvent(QEvent* event)
     if(event->type() == QEvent::StyleChange)
         mStyle->setBaseStyle(nullptr);
 
+    // badges are rendered with the palette/font colors
+    if (event->type() == QEvent::StyleChange
+            || event->type() == QEvent::PaletteChange
+            || event->type() == QEvent::FontChange)
+        mBadgeCache.clear();
+
     QFrame::changeEvent(event);
 }
 
@@ -670,8 +1466,8 @@ void LXQtTaskBar::changeEvent(QEvent* event)
 void LXQtTaskBar::registerShortcuts()
 {
     // Register shortcuts to switch to the task
-    // mPlaceHolder is always at position 0
-    // tasks are at positions 1..10
+    // mPlaceHolder is always at position 0 (followed by mPageButton)
+    // tasks are the first 10 visible groups
     GlobalKeyShortcut::Action * gshortcut;
     QString path;
     QString description;
@@ -41,6 +41,11 @@
 #include <QFrame>
 #include <QBoxLayout>
 #include <QMap>
+#include <QSet>
+#include <QHash>
+#include <QPointer>
+#include <QPixmap>
+#include <QVariant>
 #include <lxqt-globalkeys.h>
 #include "../panel/ilxqtpanel.h"
 #include <KWindowSystem/KWindowSystem>
@@ -48,19 +53,43 @@
 #include <KWindowSystem/NETWM>
 
 class QSignalMapper;
+class QToolButton;
+class QTimer;
 class LXQtTaskButton;
 class ElidedButtonStyle;
+class LXQtTaskThumbnailer;
+class LXQtTaskBarBackend;
 
 namespace LXQt {
 class GridLayout;
 }
 
+/*! \brief Lightweight record of a window for the paged (virtualized) taskbar.
+ *
+ * With the paging on, only the groups of the current page exist as widgets.
+ * All the windows are tracked by these records, which cache the state
+ * the "show only" filters need.
+ */
+struct LXQtTaskRecord
+{
+    QString group; //!< id of the group the window belongs to
+    QByteArray windowClass;
+    int desktop = 0;
+    bool minimized = false;
+    bool urgent = false;
+    quint32 screenMask = 0; //!< screens the window intersects (valid for screenEpoch)
+    int screenEpoch = -1;
+};
+
 class LXQtTaskBar : public QFrame
 {
     Q_OBJECT
 
 public:
-    explicit LXQtTaskBar(ILXQtPanelPlugin *plugin, QWidget* parent = nullptr);
+    /*! \param backend the window system backend to use (the X11 one if nullptr is given),
+     * the ownership is not transferred
+     */
+    explicit LXQtTaskBar(ILXQtPanelPlugin *plugin, QWidget* parent = nullptr, LXQtTaskBarBackend * backend = nullptr);
     virtual ~LXQtTaskBar();
 
     void realign();
@@ -79,8 +108,46 @@ public:
     bool isIconByClass() const { return mIconByClass; }
     int wheelEventsAction() const { return mWheelEventsAction; }
     int wheelDeltaThreshold() const { return mWheelDeltaThreshold; }
+    int maxTaskButtons() const { return mMaxTaskButtons; }
+    bool isShowBadges() const { return mShowBadges; }
+    //! \return provider of window thumbnails (nullptr if thumbnails are disabled)
+    LXQtTaskThumbnailer * thumbnailer() const { return mThumbnailer; }
+    //! \return index of the screen the taskbar is placed on
+    int currentScreen() const { return mCurrentScreen; }
+    //! \return serial number of the screen layout (changed on any change of screens or of the taskbar placement)
+    int screenEpoch() const { return mScreenEpoch; }
     inline ILXQtPanel * panel() const { return mPlugin->panel(); }
     inline ILXQtPanelPlugin * plugin() const { return mPlugin; }
+    inline LXQtTaskBarBackend * backend() const { return mBackend; }
+
+    /*! Schedules the refresh of the group visibility. All the requests coming
+     * in a short time (e.g. the burst of changes on desktop switch) are applied
+     * in one pass with a single relayout.
+     */
+    void requestRefreshVisibility(LXQtTaskGroup * group);
+
+    //! \return true if the paging is on (only the groups of the current page exist as widgets)
+    bool isPaged() const { return 0 < mMaxTaskButtons; }
+
+    //! Called by the dragged button when its drag&drop has finished
+    void dragFinished();
+
+    /*! Applies all the work postponed by the coalescing timers (visibility,
+     * paging, button texts) right now, e.g. to measure it along with the event
+     * that caused it.
+     */
+    void flushPendingWork();
+
+    /*! \return the (cached) pixmap of the badge showing the count
+     * \param size height of the badge in device independent pixels
+     */
+    QPixmap badgePixmap(int count, int size, qreal devicePixelRatio);
+    /*! \return the progress (0..1) the application announced by the launcher API
+     * or -1 if there is no progress to show
+     */
+    double launcherProgress(QString const & appId) const { return mLauncherProgress.value(appId, -1.0); }
+    //! \return the id used for matching the windows with the launcher entries
+    static QString launcherAppId(QString const & id);
 
 public slots:
     void settingsChanged();
@@ -101,6 +168,9 @@ private slots:
     void refreshTaskList();
     void refreshButtonRotation();
     void refreshPlaceholderVisibility();
+    void refreshPaging();
+    void refreshPendingVisibility();
+    void showOverflowMenu();
     void groupBecomeEmptySlot();
     void onWindowChanged(WId window, NET::Properties prop, NET::Properties2 prop2);
     void onWindowAdded(WId window);
@@ -108,6 +178,12 @@ private slots:
     void registerShortcuts();
     void shortcutRegistered();
     void activateTask(int pos);
+    void onActiveWindowChanged(WId window);
+    void onWindowUrgencyChanged(WId window, bool urgent);
+    void onCurrentDesktopChanged();
+    void onScreensChanged();
+    void activateWheelTarget();
+    void onLauncherEntryUpdate(QString const & appUri, QVariantMap const & properties);
 
 private:
     typedef QMap<WId, LXQtTaskGroup*> windowMap_t;
@@ -116,6 +192,23 @@ private:
     void addWindow(WId window);
     windowMap_t::iterator removeWindow(windowMap_t::iterator pos);
     void buttonMove(LXQtTaskGroup * dst, LXQtTaskGroup * src, QPoint const & pos);
+    void schedulePaging();
+    LXQtTaskGroup * createGroup(QString const & id, WId window);
+    void showGroupPage(QString const & id);
+
+    // the paged mode
+    void addRecord(WId window);
+    void removeRecord(WId window);
+    bool isShownByFilters(WId window, LXQtTaskRecord & record) const;
+    bool isGroupShown(QString const & id);
+    void materialize(QString const & id);
+    void dematerialize(LXQtTaskGroup * group);
+    void syncGroupOrder();
+    void clearGroups();
+    void refreshScreens();
+    void startWheelCycling();
+    int layoutIndexOf(LXQtTaskGroup * group);
+    void invalidateLayoutIndex() { mLayoutIndexDirty = true; mDragMove = qMakePair(-1, -1); }
 
 private:
     QMap<WId, LXQtTaskGroup*> mKnownWindows; //!< Ids of known windows (mapping to buttons/groups)
@@ -140,6 +233,8 @@ private:
     bool mIconByClass;
     int mWheelEventsAction;
     int mWheelDeltaThreshold;
+    int mMaxTaskButtons; //!< maximal number of buttons shown at once (0 - unlimited), the rest is on other pages
+    bool mShowBadges;
 
     bool acceptWindow(WId window) const;
     void setButtonStyle(Qt::ToolButtonStyle buttonStyle);
@@ -149,7 +244,36 @@ private:
     void resizeEvent(QResizeEvent *event);
 
     ILXQtPanelPlugin *mPlugin;
+    LXQtTaskBarBackend *mBackend;
     QWidget *mPlaceHolder;
+    QToolButton *mPageButton; //!< shows the current page and gives access to the windows on other pages
+    QTimer *mPagingTimer; //!< for coalescing the paging refresh requests
+    int mPage;
+    QHash<WId, LXQtTaskRecord> mRecords; //!< all the windows (in the paged mode only)
+    QHash<QString, QVector<WId>> mGroupWindows; //!< windows of the groups (in the paged mode only)
+    QStringList mGroupOrder; //!< ids of the groups in the taskbar order (in the paged mode only)
+    QHash<QString, LXQtTaskGroup *> mMaterialized; //!< groups of the current page (in the paged mode only)
+    LXQtTaskThumbnailer *mThumbnailer;
+    QHash<LXQtTaskGroup *, QPointer<LXQtTaskGroup>> mPendingVisibility; //!< groups waiting for the visibility refresh (guarded, a group can be deleted meanwhile)
+    QTimer *mVisibilityTimer; //!< for collecting the visibility refresh requests
+    bool mDesktopSwitchBatch; //!< the pending refresh collects a desktop switch
+    int mCurrentScreen;
+    int mScreenEpoch;
+
+    // mouse wheel cycling
+    int mWheelDelta; //!< accumulated wheel delta (not turned into steps yet)
+    QList<QPointer<LXQtTaskButton>> mWheelButtons; //!< visible buttons in the layout order (for the running wheel gesture)
+    int mWheelIndex; //!< index of the button (in mWheelButtons) to be activated
+    QTimer *mWheelTimer; //!< activates the target after the wheel has stopped
+
+    // drag&drop of the groups
+    QHash<LXQtTaskGroup *, int> mLayoutIndex; //!< cached positions of the groups in the layout
+    bool mLayoutIndexDirty;
+    QPair<int, int> mDragMove; //!< layout indexes (source, target) of the last move resolved to nothing (valid till the layout changes)
+
+    // badges
+    QHash<quint64, QPixmap> mBadgeCache; //!< rendered badges (by count, size & device pixel ratio)
+    QHash<QString, double> mLauncherProgress; //!< progress announced by the applications (by launcherAppId())
     LeftAlignedTextStyle *mStyle;
 };
 
@@ -0,0 +1,213 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * LXQt - a lightweight, Qt based, desktop toolset
+ * https://lxqt.org
+ *
+ * Copyright: 2026 LXQt team
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "lxqttaskbarbackend.h"
+#include "../panel/windowurgencytracker.h"
+
+#include <QX11Info>
+#include <KWindowSystem/KWindowSystem>
+#include <KWindowSystem/KWindowInfo>
+
+/************************************************
+
+ ************************************************/
+LXQtTaskBarX11Backend::LXQtTaskBarX11Backend(QObject * parent)
+    : LXQtTaskBarBackend(parent)
+{
+    connect(KWindowSystem::self(), static_cast<void (KWindowSystem::*)(WId, NET::Properties, NET::Properties2)>(&KWindowSystem::windowChanged)
+            , this, &LXQtTaskBarBackend::windowChanged);
+    connect(KWindowSystem::self(), &KWindowSystem::windowAdded, this, &LXQtTaskBarBackend::windowAdded);
+    connect(KWindowSystem::self(), &KWindowSystem::windowRemoved, this, &LXQtTaskBarBackend::windowRemoved);
+    connect(KWindowSystem::self(), &KWindowSystem::activeWindowChanged, this, &LXQtTaskBarBackend::activeWindowChanged);
+    connect(KWindowSystem::self(), &KWindowSystem::currentDesktopChanged, this, &LXQtTaskBarBackend::currentDesktopChanged);
+    connect(WindowUrgencyTracker::instance(), &WindowUrgencyTracker::urgencyChanged, this, [this] (WId window, int /*desktop*/, bool urgent) {
+        emit windowUrgencyChanged(window, urgent);
+    });
+}
+
+QList<WId> LXQtTaskBarX11Backend::stackingOrder() const
+{
+    return KWindowSystem::stackingOrder();
+}
+
+WId LXQtTaskBarX11Backend::activeWindow() const
+{
+    return KWindowSystem::activeWindow();
+}
+
+WId LXQtTaskBarX11Backend::rootWindow() const
+{
+    return QX11Info::appRootWindow();
+}
+
+bool LXQtTaskBarX11Backend::isValid(WId window) const
+{
+    return KWindowInfo(window, NET::Properties()).valid();
+}
+
+NET::WindowType LXQtTaskBarX11Backend::windowType(WId window, NET::WindowTypes supportedTypes) const
+{
+    return KWindowInfo(window, NET::WMWindowType).windowType(supportedTypes);
+}
+
+NET::States LXQtTaskBarX11Backend::windowState(WId window) const
+{
+    return KWindowInfo(window, NET::WMState).state();
+}
+
+bool LXQtTaskBarX11Backend::isMinimized(WId window) const
+{
+    return KWindowInfo(window, NET::WMState | NET::XAWMState).isMinimized();
+}
+
+int LXQtTaskBarX11Backend::windowDesktop(WId window) const
+{
+    return KWindowInfo(window, NET::WMDesktop).desktop();
+}
+
+WId LXQtTaskBarX11Backend::transientFor(WId window) const
+{
+    return KWindowInfo(window, NET::Properties(), NET::WM2TransientFor).transientFor();
+}
+
+QString LXQtTaskBarX11Backend::windowTitle(WId window) const
+{
+    KWindowInfo info(window, NET::WMVisibleName | NET::WMName);
+    return info.visibleName().isEmpty() ? info.name() : info.visibleName();
+}
+
+QByteArray LXQtTaskBarX11Backend::windowClass(WId window) const
+{
+    return KWindowInfo(window, NET::Properties(), NET::WM2WindowClass).windowClassClass();
+}
+
+QPixmap LXQtTaskBarX11Backend::windowIcon(WId window, int size) const
+{
+    return KWindowSystem::icon(window, size, size);
+}
+
+QRect LXQtTaskBarX11Backend::frameGeometry(WId window) const
+{
+    return KWindowInfo(window, NET::WMFrameExtents).frameGeometry();
+}
+
+int LXQtTaskBarX11Backend::windowPid(WId window) const
+{
+    return KWindowInfo(window, NET::WMPid).pid();
+}
+
+bool LXQtTaskBarX11Backend::isActionSupported(WId window, NET::Action action) const
+{
+    return KWindowInfo(window, NET::Properties(), NET::WM2AllowedActions).actionSupported(action);
+}
+
+NET::Actions LXQtTaskBarX11Backend::windowActions(WId window, NET::States & state) const
+{
+    KWindowInfo info(window, NET::WMState | NET::XAWMState, NET::WM2AllowedActions);
+    state = info.state();
+    if (!info.isMinimized())
+        state &= ~NET::Hidden;
+
+    NET::Actions actions;
+    for (NET::Action action : {NET::ActionMove, NET::ActionResize, NET::ActionMinimize, NET::ActionShade
+            , NET::ActionStick, NET::ActionMaxVert, NET::ActionMaxHoriz, NET::ActionMax
+            , NET::ActionFullScreen, NET::ActionChangeDesktop, NET::ActionClose})
+    {
+        // (all the actions are supported if the window manager doesn't announce them)
+        if (info.actionSupported(action))
+            actions |= action;
+    }
+    return actions;
+}
+
+int LXQtTaskBarX11Backend::currentDesktop() const
+{
+    return KWindowSystem::currentDesktop();
+}
+
+int LXQtTaskBarX11Backend::numberOfDesktops() const
+{
+    return KWindowSystem::numberOfDesktops();
+}
+
+QString LXQtTaskBarX11Backend::desktopName(int desktop) const
+{
+    return KWindowSystem::desktopName(desktop);
+}
+
+void LXQtTaskBarX11Backend::activateWindow(WId window, bool force)
+{
+    if (force)
+        KWindowSystem::forceActiveWindow(window);
+    else
+        KWindowSystem::activateWindow(window);
+}
+
+void LXQtTaskBarX11Backend::minimizeWindow(WId window)
+{
+    KWindowSystem::minimizeWindow(window);
+}
+
+void LXQtTaskBarX11Backend::unminimizeWindow(WId window)
+{
+    KWindowSystem::unminimizeWindow(window);
+}
+
+void LXQtTaskBarX11Backend::setWindowState(WId window, NET::States state)
+{
+    KWindowSystem::setState(window, state);
+}
+
+void LXQtTaskBarX11Backend::clearWindowState(WId window, NET::States state)
+{
+    KWindowSystem::clearState(window, state);
+}
+
+void LXQtTaskBarX11Backend::setWindowOnDesktop(WId window, int desktop)
+{
+    KWindowSystem::setOnDesktop(window, desktop);
+}
+
+void LXQtTaskBarX11Backend::setCurrentDesktop(int desktop)
+{
+    KWindowSystem::setCurrentDesktop(desktop);
+}
+
+void LXQtTaskBarX11Backend::closeWindow(WId window)
+{
+    NETRootInfo(QX11Info::connection(), NET::CloseWindow).closeWindowRequest(window);
+}
+
+void LXQtTaskBarX11Backend::demandAttention(WId window, bool set)
+{
+    KWindowSystem::demandAttention(window, set);
+}
+
+void LXQtTaskBarX11Backend::setWindowIconGeometry(WId window, QRect const & geometry)
+{
+    QPixmap &&icon = KWindowSystem::icon(window);
+    if (icon.rect() != geometry)
+        KWindowSystem::setIcons(window, icon.scaled(geometry.size()), icon);
+}
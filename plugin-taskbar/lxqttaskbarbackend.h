@@ -0,0 +1,149 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * LXQt - a lightweight, Qt based, desktop toolset
+ * https://lxqt.org
+ *
+ * Copyright: 2026 LXQt team
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#ifndef LXQTTASKBARBACKEND_H
+#define LXQTTASKBARBACKEND_H
+
+#include <QObject>
+#include <QList>
+#include <QRect>
+#include <QPixmap>
+#include <KWindowSystem/NETWM>
+
+/*! \brief Window system interface of the taskbar.
+ *
+ * The taskbar, groups and buttons query the windows and act on them only
+ * through this interface. LXQtTaskBarX11Backend is the (KWindowSystem based)
+ * implementation used by the panel, LXQtTaskBarMemoryBackend keeps
+ * the windows in memory (for replaying the recorded sessions).
+ */
+class LXQtTaskBarBackend : public QObject
+{
+    Q_OBJECT
+
+public:
+    using QObject::QObject;
+
+    // windows
+    virtual QList<WId> stackingOrder() const = 0;
+    virtual WId activeWindow() const = 0;
+    virtual WId rootWindow() const = 0;
+    virtual bool isValid(WId window) const = 0;
+    virtual NET::WindowType windowType(WId window, NET::WindowTypes supportedTypes = NET::AllTypesMask) const = 0;
+    virtual NET::States windowState(WId window) const = 0;
+    virtual bool isMinimized(WId window) const = 0;
+    //! \return desktop of the window (NET::OnAllDesktops for sticky windows)
+    virtual int windowDesktop(WId window) const = 0;
+    virtual WId transientFor(WId window) const = 0;
+    //! \return the visible name of the window (the name if there is no visible one)
+    virtual QString windowTitle(WId window) const = 0;
+    //! \return the class part of WM_CLASS
+    virtual QByteArray windowClass(WId window) const = 0;
+    virtual QPixmap windowIcon(WId window, int size) const = 0;
+    virtual QRect frameGeometry(WId window) const = 0;
+    virtual int windowPid(WId window) const = 0;
+    virtual bool isActionSupported(WId window, NET::Action action) const = 0;
+    /*! \return the actions supported by the window, all queried at once
+     * \param state set to the state of the window (NET::Hidden only if it is minimized)
+     */
+    virtual NET::Actions windowActions(WId window, NET::States & state) const = 0;
+
+    bool isOnDesktop(WId window, int desktop) const
+    {
+        const int d = windowDesktop(window);
+        return NET::OnAllDesktops == d || desktop == d;
+    }
+
+    // desktops
+    virtual int currentDesktop() const = 0;
+    virtual int numberOfDesktops() const = 0;
+    virtual QString desktopName(int desktop) const = 0;
+
+    // actions
+    virtual void activateWindow(WId window, bool force = false) = 0;
+    virtual void minimizeWindow(WId window) = 0;
+    virtual void unminimizeWindow(WId window) = 0;
+    virtual void setWindowState(WId window, NET::States state) = 0;
+    virtual void clearWindowState(WId window, NET::States state) = 0;
+    virtual void setWindowOnDesktop(WId window, int desktop) = 0;
+    virtual void setCurrentDesktop(int desktop) = 0;
+    virtual void closeWindow(WId window) = 0;
+    virtual void demandAttention(WId window, bool set) = 0;
+    //! let the window manager know where the window is represented (e.g. for minimizing animations)
+    virtual void setWindowIconGeometry(WId window, QRect const & geometry) = 0;
+
+signals:
+    void windowAdded(WId window);
+    void windowRemoved(WId window);
+    void windowChanged(WId window, NET::Properties prop, NET::Properties2 prop2);
+    void currentDesktopChanged(int desktop);
+    void activeWindowChanged(WId window);
+    //! the window started/stopped demanding attention
+    void windowUrgencyChanged(WId window, bool urgent);
+};
+
+/*! \brief The KWindowSystem (X11) implementation of the backend.
+ */
+class LXQtTaskBarX11Backend : public LXQtTaskBarBackend
+{
+    Q_OBJECT
+
+public:
+    explicit LXQtTaskBarX11Backend(QObject * parent = nullptr);
+
+    QList<WId> stackingOrder() const override;
+    WId activeWindow() const override;
+    WId rootWindow() const override;
+    bool isValid(WId window) const override;
+    NET::WindowType windowType(WId window, NET::WindowTypes supportedTypes = NET::AllTypesMask) const override;
+    NET::States windowState(WId window) const override;
+    bool isMinimized(WId window) const override;
+    int windowDesktop(WId window) const override;
+    WId transientFor(WId window) const override;
+    QString windowTitle(WId window) const override;
+    QByteArray windowClass(WId window) const override;
+    QPixmap windowIcon(WId window, int size) const override;
+    QRect frameGeometry(WId window) const override;
+    int windowPid(WId window) const override;
+    bool isActionSupported(WId window, NET::Action action) const override;
+    NET::Actions windowActions(WId window, NET::States & state) const override;
+
+    int currentDesktop() const override;
+    int numberOfDesktops() const override;
+    QString desktopName(int desktop) const override;
+
+    void activateWindow(WId window, bool force = false) override;
+    void minimizeWindow(WId window) override;
+    void unminimizeWindow(WId window) override;
+    void setWindowState(WId window, NET::States state) override;
+    void clearWindowState(WId window, NET::States state) override;
+    void setWindowOnDesktop(WId window, int desktop) override;
+    void setCurrentDesktop(int desktop) override;
+    void closeWindow(WId window) override;
+    void demandAttention(WId window, bool set) override;
+    void setWindowIconGeometry(WId window, QRect const & geometry) override;
+};
+
+#endif // LXQTTASKBARBACKEND_H
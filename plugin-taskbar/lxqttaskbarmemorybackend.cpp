@@ -0,0 +1,266 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * LXQt - a lightweight, Qt based, desktop toolset
+ * https://lxqt.org
+ *
+ * Copyright: 2026 LXQt team
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "lxqttaskbarmemorybackend.h"
+
+/************************************************
+
+ ************************************************/
+LXQtTaskBarMemoryBackend::LXQtTaskBarMemoryBackend(QObject * parent)
+    : LXQtTaskBarBackend(parent)
+    , mActiveWindow(0)
+    , mCurrentDesktop(1)
+    , mDesktopCount(1)
+{
+}
+
+/************************************************
+
+ ************************************************/
+void LXQtTaskBarMemoryBackend::addWindow(WId window, LXQtWindowSnapshot const & snapshot)
+{
+    if (!snapshot.valid)
+        return;
+
+    const bool known = mWindows.contains(window);
+    mWindows[window] = snapshot;
+    if (known)
+        return;
+    mStackingOrder.append(window);
+    mDesktopCount = qMax(mDesktopCount, snapshot.desktop);
+    emit windowAdded(window);
+}
+
+/************************************************
+
+ ************************************************/
+void LXQtTaskBarMemoryBackend::changeWindow(WId window, LXQtWindowSnapshot const & snapshot, NET::Properties prop, NET::Properties2 prop2)
+{
+    auto i = mWindows.find(window);
+    if (mWindows.end() == i)
+        return;
+    // the window could have been gone at the time of taking the snapshot
+    const bool was_urgent = i->state & NET::DemandsAttention;
+    if (snapshot.valid)
+    {
+        *i = snapshot;
+        mDesktopCount = qMax(mDesktopCount, snapshot.desktop);
+    }
+    emit windowChanged(window, prop, prop2);
+    const bool urgent = i->state & NET::DemandsAttention;
+    if (urgent != was_urgent)
+        emit windowUrgencyChanged(window, urgent);
+}
+
+/************************************************
+
+ ************************************************/
+void LXQtTaskBarMemoryBackend::removeWindow(WId window)
+{
+    if (0 == mWindows.remove(window))
+        return;
+    mStackingOrder.removeAll(window);
+    if (mActiveWindow == window)
+        mActiveWindow = 0;
+    emit windowRemoved(window);
+}
+
+/************************************************
+
+ ************************************************/
+void LXQtTaskBarMemoryBackend::changeCurrentDesktop(int desktop)
+{
+    mDesktopCount = qMax(mDesktopCount, desktop);
+    if (mCurrentDesktop == desktop)
+        return;
+    mCurrentDesktop = desktop;
+    emit currentDesktopChanged(desktop);
+}
+
+/************************************************
+
+ ************************************************/
+void LXQtTaskBarMemoryBackend::changeActiveWindow(WId window)
+{
+    if (mActiveWindow == window)
+        return;
+    mActiveWindow = window;
+    if (mStackingOrder.removeOne(window))
+        mStackingOrder.append(window);
+    emit activeWindowChanged(window);
+}
+
+/************************************************
+
+ ************************************************/
+NET::WindowType LXQtTaskBarMemoryBackend::windowType(WId window, NET::WindowTypes supportedTypes) const
+{
+    const NET::WindowType type = static_cast<NET::WindowType>(mWindows.value(window).windowType);
+    // the recorded type is the one reported for all the types supported
+    return NET::typeMatchesMask(type, supportedTypes) ? type : NET::Unknown;
+}
+
+NET::States LXQtTaskBarMemoryBackend::windowState(WId window) const
+{
+    return NET::States(QFlag(mWindows.value(window).state));
+}
+
+bool LXQtTaskBarMemoryBackend::isMinimized(WId window) const
+{
+    return windowState(window).testFlag(NET::Hidden);
+}
+
+int LXQtTaskBarMemoryBackend::windowDesktop(WId window) const
+{
+    return mWindows.value(window).desktop;
+}
+
+WId LXQtTaskBarMemoryBackend::transientFor(WId window) const
+{
+    return mWindows.value(window).transientFor;
+}
+
+QString LXQtTaskBarMemoryBackend::windowTitle(WId window) const
+{
+    const LXQtWindowSnapshot snapshot = mWindows.value(window);
+    return snapshot.visibleName.isEmpty() ? snapshot.name : snapshot.visibleName;
+}
+
+QByteArray LXQtTaskBarMemoryBackend::windowClass(WId window) const
+{
+    return mWindows.value(window).windowClassClass;
+}
+
+QPixmap LXQtTaskBarMemoryBackend::windowIcon(WId /*window*/, int /*size*/) const
+{
+    // no icons are recorded, the default one is used
+    return QPixmap();
+}
+
+QRect LXQtTaskBarMemoryBackend::frameGeometry(WId window) const
+{
+    return mWindows.value(window).frameGeometry;
+}
+
+int LXQtTaskBarMemoryBackend::windowPid(WId window) const
+{
+    return mWindows.value(window).pid;
+}
+
+bool LXQtTaskBarMemoryBackend::isActionSupported(WId window, NET::Action /*action*/) const
+{
+    return mWindows.contains(window);
+}
+
+NET::Actions LXQtTaskBarMemoryBackend::windowActions(WId window, NET::States & state) const
+{
+    state = windowState(window);
+    return mWindows.contains(window) ? NET::Actions(QFlag(~0)) : NET::Actions();
+}
+
+QString LXQtTaskBarMemoryBackend::desktopName(int desktop) const
+{
+    return QStringLiteral("Desktop %1").arg(desktop);
+}
+
+/************************************************
+
+ ************************************************/
+void LXQtTaskBarMemoryBackend::activateWindow(WId window, bool /*force*/)
+{
+    if (!mWindows.contains(window))
+        return;
+    unminimizeWindow(window);
+    changeActiveWindow(window);
+}
+
+void LXQtTaskBarMemoryBackend::minimizeWindow(WId window)
+{
+    changeState(window, NET::Hidden, NET::States());
+}
+
+void LXQtTaskBarMemoryBackend::unminimizeWindow(WId window)
+{
+    changeState(window, NET::States(), NET::Hidden);
+}
+
+void LXQtTaskBarMemoryBackend::setWindowState(WId window, NET::States state)
+{
+    changeState(window, state, NET::States());
+}
+
+void LXQtTaskBarMemoryBackend::clearWindowState(WId window, NET::States state)
+{
+    changeState(window, NET::States(), state);
+}
+
+void LXQtTaskBarMemoryBackend::setWindowOnDesktop(WId window, int desktop)
+{
+    auto i = mWindows.find(window);
+    if (mWindows.end() == i || i->desktop == desktop)
+        return;
+    i->desktop = desktop;
+    emit windowChanged(window, NET::WMDesktop, NET::Properties2());
+}
+
+void LXQtTaskBarMemoryBackend::setCurrentDesktop(int desktop)
+{
+    changeCurrentDesktop(desktop);
+}
+
+void LXQtTaskBarMemoryBackend::closeWindow(WId window)
+{
+    removeWindow(window);
+}
+
+void LXQtTaskBarMemoryBackend::demandAttention(WId window, bool set)
+{
+    if (set)
+        changeState(window, NET::DemandsAttention, NET::States());
+    else
+        changeState(window, NET::States(), NET::DemandsAttention);
+}
+
+void LXQtTaskBarMemoryBackend::setWindowIconGeometry(WId /*window*/, QRect const & /*geometry*/)
+{
+}
+
+/************************************************
+
+ ************************************************/
+void LXQtTaskBarMemoryBackend::changeState(WId window, NET::States set, NET::States clear)
+{
+    auto i = mWindows.find(window);
+    if (mWindows.end() == i)
+        return;
+    const quint32 state = (i->state | static_cast<quint32>(set)) & ~static_cast<quint32>(clear);
+    if (state == i->state)
+        return;
+    const bool urgency_changed = (state ^ i->state) & NET::DemandsAttention;
+    i->state = state;
+    emit windowChanged(window, NET::WMState, NET::Properties2());
+    if (urgency_changed)
+        emit windowUrgencyChanged(window, state & NET::DemandsAttention);
+}
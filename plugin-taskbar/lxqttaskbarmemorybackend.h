@@ -0,0 +1,99 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * LXQt - a lightweight, Qt based, desktop toolset
+ * https://lxqt.org
+ *
+ * Copyright: 2026 LXQt team
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#ifndef LXQTTASKBARMEMORYBACKEND_H
+#define LXQTTASKBARMEMORYBACKEND_H
+
+#include "lxqttaskbarbackend.h"
+#include "lxqttaskbarrecorder.h"
+
+#include <QHash>
+
+/*! \brief Backend keeping the windows in memory.
+ *
+ * The windows are described by LXQtWindowSnapshot and are manipulated by
+ * the add/change/remove methods, which emit the same signals as a real
+ * window system would. The actions requested by the taskbar are applied
+ * to the in-memory state directly.
+ */
+class LXQtTaskBarMemoryBackend : public LXQtTaskBarBackend
+{
+    Q_OBJECT
+
+public:
+    explicit LXQtTaskBarMemoryBackend(QObject * parent = nullptr);
+
+    // window system "events"
+    void addWindow(WId window, LXQtWindowSnapshot const & snapshot);
+    void changeWindow(WId window, LXQtWindowSnapshot const & snapshot, NET::Properties prop, NET::Properties2 prop2);
+    void removeWindow(WId window);
+    void changeCurrentDesktop(int desktop);
+    void changeActiveWindow(WId window);
+    void setNumberOfDesktops(int count) { mDesktopCount = count; }
+
+    QList<WId> stackingOrder() const override { return mStackingOrder; }
+    WId activeWindow() const override { return mActiveWindow; }
+    WId rootWindow() const override { return 0; }
+    bool isValid(WId window) const override { return mWindows.contains(window); }
+    NET::WindowType windowType(WId window, NET::WindowTypes supportedTypes = NET::AllTypesMask) const override;
+    NET::States windowState(WId window) const override;
+    bool isMinimized(WId window) const override;
+    int windowDesktop(WId window) const override;
+    WId transientFor(WId window) const override;
+    QString windowTitle(WId window) const override;
+    QByteArray windowClass(WId window) const override;
+    QPixmap windowIcon(WId window, int size) const override;
+    QRect frameGeometry(WId window) const override;
+    int windowPid(WId window) const override;
+    bool isActionSupported(WId window, NET::Action action) const override;
+    NET::Actions windowActions(WId window, NET::States & state) const override;
+
+    int currentDesktop() const override { return mCurrentDesktop; }
+    int numberOfDesktops() const override { return mDesktopCount; }
+    QString desktopName(int desktop) const override;
+
+    void activateWindow(WId window, bool force = false) override;
+    void minimizeWindow(WId window) override;
+    void unminimizeWindow(WId window) override;
+    void setWindowState(WId window, NET::States state) override;
+    void clearWindowState(WId window, NET::States state) override;
+    void setWindowOnDesktop(WId window, int desktop) override;
+    void setCurrentDesktop(int desktop) override;
+    void closeWindow(WId window) override;
+    void demandAttention(WId window, bool set) override;
+    void setWindowIconGeometry(WId window, QRect const & geometry) override;
+
+private:
+    void changeState(WId window, NET::States set, NET::States clear);
+
+private:
+    QHash<WId, LXQtWindowSnapshot> mWindows;
+    QList<WId> mStackingOrder;
+    WId mActiveWindow;
+    int mCurrentDesktop;
+    int mDesktopCount;
+};
+
+#endif // LXQTTASKBARMEMORYBACKEND_H
@@ -27,6 +27,9 @@
 
 
 #include "lxqttaskbarplugin.h"
+#include "lxqttaskbarrecorder.h"
+
+#include <QTimer>
 
 LXQtTaskBarPlugin::LXQtTaskBarPlugin(const ILXQtPanelPluginStartupInfo &startupInfo):
     QObject(),
@@ -35,6 +38,19 @@ LXQtTaskBarPlugin::LXQtTaskBarPlugin(const ILXQtPanelPluginStartupInfo &startupI
 {
     mTaskBar = new LXQtTaskBar(this);
 
+    // diagnostics: recording of the window system events & replaying them for measurements
+    const QString record = qEnvironmentVariable("LXQT_TASKBAR_RECORD");
+    if (!record.isEmpty())
+        new LXQtTaskBarRecorder(record, mTaskBar);
+    const QString replay = qEnvironmentVariable("LXQT_TASKBAR_REPLAY");
+    if (!replay.isEmpty())
+    {
+        QTimer::singleShot(0, mTaskBar, [this, replay] {
+            LXQtTaskBarReplay player(this, mTaskBar->size());
+            if (player.load(replay))
+                player.run();
+        });
+    }
 }
 
 
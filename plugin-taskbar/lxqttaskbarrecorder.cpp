@@ -0,0 +1,383 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * LXQt - a lightweight, Qt based, desktop toolset
+ * https://lxqt.org
+ *
+ * Copyright: 2026 LXQt team
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "lxqttaskbarrecorder.h"
+#include "lxqttaskbar.h"
+#include "lxqttaskbarmemorybackend.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <KWindowSystem/KWindowSystem>
+#include <KWindowSystem/KWindowInfo>
+
+#include <algorithm>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+namespace
+{
+    const quint32 RECORD_MAGIC = 0x4c585442; // "LXTB"
+    const quint32 RECORD_VERSION = 1;
+
+    //! \return bytes allocated on the heap (-1 if unknown)
+    qint64 heapInUse()
+    {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+        const struct mallinfo2 info = mallinfo2();
+        return static_cast<qint64>(info.uordblks + info.hblkhd);
+#else
+        return -1;
+#endif
+    }
+}
+
+/************************************************
+
+ ************************************************/
+LXQtWindowSnapshot LXQtWindowSnapshot::take(WId window)
+{
+    LXQtWindowSnapshot snapshot;
+    KWindowInfo info(window
+            , NET::WMName | NET::WMVisibleName | NET::WMDesktop | NET::WMState | NET::WMWindowType | NET::WMFrameExtents | NET::WMPid
+            , NET::WM2WindowClass | NET::WM2TransientFor);
+    if (!info.valid())
+        return snapshot;
+
+    snapshot.valid = true;
+    snapshot.name = info.name();
+    snapshot.visibleName = info.visibleName();
+    snapshot.windowClassClass = info.windowClassClass();
+    snapshot.windowClassName = info.windowClassName();
+    snapshot.desktop = info.desktop();
+    snapshot.state = static_cast<quint32>(info.state());
+    snapshot.windowType = info.windowType(NET::AllTypesMask);
+    snapshot.transientFor = info.transientFor();
+    snapshot.frameGeometry = info.frameGeometry();
+    snapshot.pid = info.pid();
+    return snapshot;
+}
+
+/************************************************
+
+ ************************************************/
+QDataStream & operator<<(QDataStream & stream, LXQtWindowSnapshot const & snapshot)
+{
+    stream << snapshot.valid;
+    if (snapshot.valid)
+        stream << snapshot.name << snapshot.visibleName << snapshot.windowClassClass << snapshot.windowClassName
+            << qint32(snapshot.desktop) << snapshot.state << qint32(snapshot.windowType) << snapshot.transientFor
+            << snapshot.frameGeometry << qint32(snapshot.pid);
+    return stream;
+}
+
+QDataStream & operator>>(QDataStream & stream, LXQtWindowSnapshot & snapshot)
+{
+    snapshot = LXQtWindowSnapshot{};
+    stream >> snapshot.valid;
+    if (snapshot.valid)
+    {
+        qint32 desktop, type, pid;
+        stream >> snapshot.name >> snapshot.visibleName >> snapshot.windowClassClass >> snapshot.windowClassName
+            >> desktop >> snapshot.state >> type >> snapshot.transientFor
+            >> snapshot.frameGeometry >> pid;
+        snapshot.desktop = desktop;
+        snapshot.windowType = type;
+        snapshot.pid = pid;
+    }
+    return stream;
+}
+
+QDataStream & operator<<(QDataStream & stream, LXQtTaskBarEvent const & event)
+{
+    stream << quint8(event.type) << event.time << event.window;
+    switch (event.type)
+    {
+    case LXQtTaskBarEvent::WindowChanged:
+        stream << event.properties << event.properties2 << event.snapshot;
+        break;
+    case LXQtTaskBarEvent::WindowAdded:
+        stream << event.snapshot;
+        break;
+    case LXQtTaskBarEvent::CurrentDesktopChanged:
+        stream << qint32(event.desktop);
+        break;
+    case LXQtTaskBarEvent::WindowRemoved:
+    case LXQtTaskBarEvent::ActiveWindowChanged:
+        break;
+    }
+    return stream;
+}
+
+QDataStream & operator>>(QDataStream & stream, LXQtTaskBarEvent & event)
+{
+    event = LXQtTaskBarEvent{};
+    quint8 type;
+    stream >> type >> event.time >> event.window;
+    event.type = static_cast<LXQtTaskBarEvent::Type>(type);
+    switch (event.type)
+    {
+    case LXQtTaskBarEvent::WindowChanged:
+        stream >> event.properties >> event.properties2 >> event.snapshot;
+        break;
+    case LXQtTaskBarEvent::WindowAdded:
+        stream >> event.snapshot;
+        break;
+    case LXQtTaskBarEvent::CurrentDesktopChanged:
+    {
+        qint32 desktop;
+        stream >> desktop;
+        event.desktop = desktop;
+        break;
+    }
+    case LXQtTaskBarEvent::WindowRemoved:
+    case LXQtTaskBarEvent::ActiveWindowChanged:
+        break;
+    default:
+        stream.setStatus(QDataStream::ReadCorruptData);
+    }
+    return stream;
+}
+
+/************************************************
+
+ ************************************************/
+LXQtTaskBarRecorder::LXQtTaskBarRecorder(QString const & fileName, QObject * parent)
+    : QObject(parent)
+    , mFile(fileName)
+{
+    if (!mFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        qWarning() << "LXQtTaskBarRecorder: unable to open" << fileName << "for writing:" << mFile.errorString();
+        return;
+    }
+    mStream.setDevice(&mFile);
+    mStream.setVersion(QDataStream::Qt_5_12);
+    mStream << RECORD_MAGIC << RECORD_VERSION;
+    mTime.start();
+
+    // the initial state of the session
+    const auto windows = KWindowSystem::stackingOrder();
+    for (WId window : windows)
+    {
+        LXQtTaskBarEvent event;
+        event.type = LXQtTaskBarEvent::WindowAdded;
+        event.window = window;
+        record(event);
+    }
+    {
+        LXQtTaskBarEvent event;
+        event.type = LXQtTaskBarEvent::CurrentDesktopChanged;
+        event.desktop = KWindowSystem::currentDesktop();
+        record(event);
+        event.type = LXQtTaskBarEvent::ActiveWindowChanged;
+        event.window = KWindowSystem::activeWindow();
+        record(event);
+    }
+
+    connect(KWindowSystem::self(), &KWindowSystem::windowAdded, this, [this] (WId window) {
+        LXQtTaskBarEvent event;
+        event.type = LXQtTaskBarEvent::WindowAdded;
+        event.window = window;
+        record(event);
+    });
+    connect(KWindowSystem::self(), &KWindowSystem::windowRemoved, this, [this] (WId window) {
+        LXQtTaskBarEvent event;
+        event.type = LXQtTaskBarEvent::WindowRemoved;
+        event.window = window;
+        record(event);
+    });
+    connect(KWindowSystem::self(), static_cast<void (KWindowSystem::*)(WId, NET::Properties, NET::Properties2)>(&KWindowSystem::windowChanged)
+            , this, [this] (WId window, NET::Properties prop, NET::Properties2 prop2) {
+        LXQtTaskBarEvent event;
+        event.type = LXQtTaskBarEvent::WindowChanged;
+        event.window = window;
+        event.properties = static_cast<quint32>(prop);
+        event.properties2 = static_cast<quint32>(prop2);
+        record(event);
+    });
+    connect(KWindowSystem::self(), &KWindowSystem::currentDesktopChanged, this, [this] (int desktop) {
+        LXQtTaskBarEvent event;
+        event.type = LXQtTaskBarEvent::CurrentDesktopChanged;
+        event.desktop = desktop;
+        record(event);
+    });
+    connect(KWindowSystem::self(), &KWindowSystem::activeWindowChanged, this, [this] (WId window) {
+        LXQtTaskBarEvent event;
+        event.type = LXQtTaskBarEvent::ActiveWindowChanged;
+        event.window = window;
+        record(event);
+    });
+}
+
+/************************************************
+
+ ************************************************/
+bool LXQtTaskBarRecorder::readHeader(QDataStream & stream)
+{
+    quint32 magic = 0, version = 0;
+    stream.setVersion(QDataStream::Qt_5_12);
+    stream >> magic >> version;
+    return RECORD_MAGIC == magic && RECORD_VERSION == version;
+}
+
+/************************************************
+
+ ************************************************/
+void LXQtTaskBarRecorder::record(LXQtTaskBarEvent & event)
+{
+    if (!mFile.isOpen())
+        return;
+
+    event.time = mTime.elapsed();
+    if (LXQtTaskBarEvent::WindowAdded == event.type || LXQtTaskBarEvent::WindowChanged == event.type)
+        event.snapshot = LXQtWindowSnapshot::take(event.window);
+    mStream << event;
+    // keep the file usable even if the panel doesn't end gracefully
+    mFile.flush();
+}
+
+/************************************************
+
+ ************************************************/
+LXQtTaskBarReplay::LXQtTaskBarReplay(ILXQtPanelPlugin * plugin, QSize const & size)
+    : mPlugin(plugin)
+    , mSize(size)
+    , mBackend(nullptr)
+{
+}
+
+/************************************************
+
+ ************************************************/
+bool LXQtTaskBarReplay::load(QString const & fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        qWarning() << "LXQtTaskBarReplay: unable to open" << fileName << ":" << file.errorString();
+        return false;
+    }
+    QDataStream stream(&file);
+    if (!LXQtTaskBarRecorder::readHeader(stream))
+    {
+        qWarning() << "LXQtTaskBarReplay:" << fileName << "is not a taskbar recording";
+        return false;
+    }
+
+    mEvents.clear();
+    while (!stream.atEnd())
+    {
+        LXQtTaskBarEvent event;
+        stream >> event;
+        if (QDataStream::Ok != stream.status())
+        {
+            // the recording could have been cut in the middle of the event
+            qWarning() << "LXQtTaskBarReplay: corrupted record after" << mEvents.count() << "events, ignoring the rest";
+            break;
+        }
+        mEvents.append(event);
+    }
+    return true;
+}
+
+/************************************************
+
+ ************************************************/
+void LXQtTaskBarReplay::run()
+{
+    if (mEvents.isEmpty())
+        return;
+
+    LXQtTaskBarMemoryBackend backend;
+    LXQtTaskBar taskBar(mPlugin, nullptr, &backend);
+    taskBar.setAttribute(Qt::WA_DontShowOnScreen);
+    taskBar.resize(mSize);
+    taskBar.show();
+    // let the taskbar apply the settings
+    QCoreApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
+    mBackend = &backend;
+
+    QVector<qint64> latencies;
+    latencies.reserve(mEvents.count());
+    const qint64 heapBefore = heapInUse();
+    QElapsedTimer total;
+    total.start();
+    for (LXQtTaskBarEvent const & event : qAsConst(mEvents))
+    {
+        QElapsedTimer timer;
+        timer.start();
+        dispatch(event);
+        // the work postponed by the coalescing timers is forced to run now (it
+        // wouldn't wait for the timers otherwise), then the layout requests it posted
+        QCoreApplication::sendPostedEvents();
+        taskBar.flushPendingWork();
+        QCoreApplication::sendPostedEvents();
+        QCoreApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
+        latencies.append(timer.nsecsElapsed());
+    }
+    // anything the last events left behind
+    taskBar.flushPendingWork();
+    QCoreApplication::sendPostedEvents();
+    const qint64 totalNs = total.nsecsElapsed();
+    const qint64 heapAfter = heapInUse();
+    mBackend = nullptr;
+
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&latencies] (int p) {
+        return latencies[qMin(latencies.count() - 1, latencies.count() * p / 100)];
+    };
+    qInfo("LXQtTaskBarReplay: %d events, total %.3f ms, per event p50 %.1f us, p99 %.1f us, max %.1f us"
+            , latencies.count(), totalNs / 1e6, percentile(50) / 1e3, percentile(99) / 1e3, latencies.last() / 1e3);
+    // the number of allocations is not available without replacing the global
+    // operator new of the whole panel, report at least the growth of the heap
+    if (0 <= heapBefore)
+        qInfo("LXQtTaskBarReplay: heap in use grew by %lld bytes", static_cast<long long>(heapAfter - heapBefore));
+}
+
+/************************************************
+
+ ************************************************/
+void LXQtTaskBarReplay::dispatch(LXQtTaskBarEvent const & event)
+{
+    switch (event.type)
+    {
+    case LXQtTaskBarEvent::WindowAdded:
+        mBackend->addWindow(event.window, event.snapshot);
+        break;
+    case LXQtTaskBarEvent::WindowRemoved:
+        mBackend->removeWindow(event.window);
+        break;
+    case LXQtTaskBarEvent::WindowChanged:
+        mBackend->changeWindow(event.window, event.snapshot, NET::Properties(QFlag(event.properties)), NET::Properties2(QFlag(event.properties2)));
+        break;
+    case LXQtTaskBarEvent::CurrentDesktopChanged:
+        mBackend->changeCurrentDesktop(event.desktop);
+        break;
+    case LXQtTaskBarEvent::ActiveWindowChanged:
+        mBackend->changeActiveWindow(event.window);
+        break;
+    }
+}
@@ -0,0 +1,138 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * LXQt - a lightweight, Qt based, desktop toolset
+ * https://lxqt.org
+ *
+ * Copyright: 2026 LXQt team
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#ifndef LXQTTASKBARRECORDER_H
+#define LXQTTASKBARRECORDER_H
+
+#include <QObject>
+#include <QFile>
+#include <QDataStream>
+#include <QElapsedTimer>
+#include <QRect>
+#include <QVector>
+#include <QSize>
+#include <KWindowSystem/NETWM>
+
+class ILXQtPanelPlugin;
+class LXQtTaskBarMemoryBackend;
+
+/*! \brief Snapshot of the window properties the taskbar is interested in.
+ *
+ * It is stored along with the recorded events, so the session can be replayed
+ * without the original windows being around.
+ */
+struct LXQtWindowSnapshot
+{
+    bool valid = false;
+    QString name;
+    QString visibleName;
+    QByteArray windowClassClass;
+    QByteArray windowClassName;
+    int desktop = 0;
+    quint32 state = 0; //!< NET::States
+    int windowType = NET::Unknown;
+    quint64 transientFor = 0;
+    QRect frameGeometry;
+    int pid = 0;
+
+    static LXQtWindowSnapshot take(WId window);
+};
+
+/*! \brief One recorded window system event.
+ */
+struct LXQtTaskBarEvent
+{
+    enum Type : quint8
+    {
+        WindowAdded,
+        WindowRemoved,
+        WindowChanged,
+        CurrentDesktopChanged,
+        ActiveWindowChanged
+    };
+
+    Type type = WindowAdded;
+    qint64 time = 0; //!< ms since the start of the recording
+    quint64 window = 0;
+    quint32 properties = 0; //!< NET::Properties (for WindowChanged)
+    quint32 properties2 = 0; //!< NET::Properties2 (for WindowChanged)
+    int desktop = 0; //!< for CurrentDesktopChanged
+    LXQtWindowSnapshot snapshot; //!< for WindowAdded & WindowChanged
+};
+
+QDataStream & operator<<(QDataStream & stream, LXQtWindowSnapshot const & snapshot);
+QDataStream & operator>>(QDataStream & stream, LXQtWindowSnapshot & snapshot);
+QDataStream & operator<<(QDataStream & stream, LXQtTaskBarEvent const & event);
+QDataStream & operator>>(QDataStream & stream, LXQtTaskBarEvent & event);
+
+/*! \brief Records the window system events of the session into a file
+ * (enabled by the LXQT_TASKBAR_RECORD environment variable).
+ */
+class LXQtTaskBarRecorder : public QObject
+{
+    Q_OBJECT
+
+public:
+    LXQtTaskBarRecorder(QString const & fileName, QObject * parent = nullptr);
+
+    static bool readHeader(QDataStream & stream);
+
+private:
+    void record(LXQtTaskBarEvent & event);
+
+private:
+    QFile mFile;
+    QDataStream mStream;
+    QElapsedTimer mTime;
+};
+
+/*! \brief Replays the recorded events against the taskbar and reports
+ * the processing times (enabled by the LXQT_TASKBAR_REPLAY environment variable).
+ *
+ * A private (not shown on screen) taskbar with the in-memory window
+ * system backend is used, so no real window is touched.
+ */
+class LXQtTaskBarReplay
+{
+public:
+    LXQtTaskBarReplay(ILXQtPanelPlugin * plugin, QSize const & size);
+
+    bool load(QString const & fileName);
+    void run();
+
+    //! \return the loaded events
+    QVector<LXQtTaskBarEvent> const & events() const { return mEvents; }
+
+private:
+    void dispatch(LXQtTaskBarEvent const & event);
+
+private:
+    ILXQtPanelPlugin * mPlugin;
+    QSize mSize;
+    LXQtTaskBarMemoryBackend * mBackend;
+    QVector<LXQtTaskBarEvent> mEvents;
+};
+
+#endif // LXQTTASKBARRECORDER_H
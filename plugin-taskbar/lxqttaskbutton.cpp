@@ -30,6 +30,7 @@
 #include "lxqttaskbutton.h"
 #include "lxqttaskgroup.h"
 #include "lxqttaskbar.h"
+#include "lxqttaskbarbackend.h"
 
 #include <LXQt/Settings>
 
@@ -70,9 +71,14 @@ void LeftAlignedTextStyle::drawItemText(QPainter * painter, const QRect & rect,
 {
     QString txt = text;
     // get the button text because the text that's given to this function may be middle-elided
-    if (const QToolButton *tb = dynamic_cast<const QToolButton*>(painter->device()))
-        txt = tb->text();
-    txt = QFontMetrics(painter->font()).elidedText(txt, Qt::ElideRight, rect.width());
+    if (const LXQtTaskButton *tb = dynamic_cast<const LXQtTaskButton*>(painter->device()))
+        txt = tb->elidedText(painter->font(), rect.width());
+    else
+    {
+        if (const QToolButton *tb = dynamic_cast<const QToolButton*>(painter->device()))
+            txt = tb->text();
+        txt = QFontMetrics(painter->font()).elidedText(txt, Qt::ElideRight, rect.width());
+    }
     QProxyStyle::drawItemText(painter, rect, (flags & ~Qt::AlignHCenter) | Qt::AlignLeft, pal, enabled, txt, textRole);
 }
 
@@ -91,7 +97,12 @@ LXQtTaskButton::LXQtTaskButton(const WId window, LXQtTaskBar * taskbar, QWidget
     mIconSize(mPlugin->panel()->iconSize()),
     mWheelDelta(0),
     mDNDTimer(new QTimer(this)),
-    mWheelTimer(new QTimer(this))
+    mWheelTimer(new QTimer(this)),
+    mTextTimer(new QTimer(this)),
+    mTextPending(false),
+    mElidedWidth(-1),
+    mScreenMask(0),
+    mScreenEpoch(-1)
 {
     Q_ASSERT(taskbar);
 
@@ -103,6 +114,13 @@ LXQtTaskButton::LXQtTaskButton(const WId window, LXQtTaskBar * taskbar, QWidget
     setToolButtonStyle(Qt::ToolButtonTextBesideIcon);
     setAcceptDrops(true);
 
+    mTextTimer->setSingleShot(true);
+    mTextTimer->setInterval(250);
+    connect(mTextTimer, &QTimer::timeout, this, [this] {
+        if (mTextPending)
+            applyText();
+    });
+
     updateText();
     updateIcon();
 
@@ -130,12 +148,79 @@ LXQtTaskButton::~LXQtTaskButton() = default;
  ************************************************/
 void LXQtTaskButton::updateText()
 {
-    KWindowInfo info(mWindow, NET::WMVisibleName | NET::WMName);
-    QString title = info.visibleName().isEmpty() ? info.name() : info.visibleName();
+    // the first change is applied immediately, the following ones
+    // are postponed till the end of the interval and coalesced
+    if (mTextTimer->isActive())
+        mTextPending = true;
+    else
+        applyText();
+}
+
+/************************************************
+
+ ************************************************/
+void LXQtTaskButton::flushText()
+{
+    if (mTextPending)
+        applyText();
+}
+
+/************************************************
+
+ ************************************************/
+void LXQtTaskButton::applyText()
+{
+    mTextPending = false;
+    mTextTimer->start();
+
+    QString title = backend()->windowTitle(mWindow);
     setText(title.replace(QStringLiteral("&"), QStringLiteral("&&")));
     setToolTip(title);
 }
 
+/************************************************
+
+ ************************************************/
+QString const & LXQtTaskButton::elidedText(QFont const & font, int width) const
+{
+    const QString txt = text();
+    if (mElidedWidth != width || mElidedSource != txt || mElidedFont != font)
+    {
+        mElidedText = QFontMetrics(font).elidedText(txt, Qt::ElideRight, width);
+        mElidedSource = txt;
+        mElidedFont = font;
+        mElidedWidth = width;
+    }
+    return mElidedText;
+}
+
+/************************************************
+
+ ************************************************/
+void LXQtTaskButton::setThumbnail(QImage const & thumbnail, QSize const & area)
+{
+    const bool areaChanged = mThumbnailArea != area;
+    mThumbnail = area.isValid() ? thumbnail : QImage();
+    mThumbnailArea = area;
+    if (areaChanged)
+        updateGeometry();
+    update();
+}
+
+/************************************************
+
+ ************************************************/
+QSize LXQtTaskButton::sizeHint() const
+{
+    QSize hint = QToolButton::sizeHint();
+    if (mThumbnailArea.isValid())
+    {
+        hint.rheight() += mThumbnailArea.height() + thumbnailMargin();
+        hint.setWidth(qMax(hint.width(), mThumbnailArea.width() + 2 * thumbnailMargin()));
+    }
+    return hint;
+}
+
 /************************************************
 
  ************************************************/
@@ -144,12 +229,12 @@ void LXQtTaskButton::updateIcon()
     QIcon ico;
     if (mParentTaskBar->isIconByClass())
     {
-        ico = XdgIcon::fromTheme(QString::fromUtf8(KWindowInfo{mWindow, NET::Properties(), NET::WM2WindowClass}.windowClassClass()).toLower());
+        ico = XdgIcon::fromTheme(QString::fromUtf8(backend()->windowClass(mWindow)).toLower());
     }
     if (ico.isNull())
     {
         int devicePixels = mIconSize * devicePixelRatioF();
-        ico = KWindowSystem::icon(mWindow, devicePixels, devicePixels);
+        ico = backend()->windowIcon(mWindow, devicePixels);
     }
     setIcon(ico.isNull() ? XdgIcon::defaultApplicationIcon() : ico);
 }
@@ -159,9 +244,7 @@ void LXQtTaskButton::updateIcon()
  ************************************************/
 void LXQtTaskButton::refreshIconGeometry(QRect const & geom)
 {
-    QPixmap &&icon = KWindowSystem::icon(windowId());
-    if (icon.rect() != geom)
-        KWindowSystem::setIcons(windowId(), icon.scaled(geom.size()), icon);
+    backend()->setWindowIconGeometry(windowId(), geom);
 }
 
 /************************************************
@@ -180,6 +263,8 @@ void LXQtTaskButton::changeEvent(QEvent *event)
             updateIcon();
         }
     }
+    else if (event->type() == QEvent::FontChange)
+        mElidedWidth = -1;
 
     QToolButton::changeEvent(event);
 }
@@ -192,7 +277,7 @@ void LXQtTaskButton::dragEnterEvent(QDragEnterEvent *event)
     // It must be here otherwise dragLeaveEvent and dragMoveEvent won't be called
     // on the other hand drop and dragmove events of parent widget won't be called
     event->acceptProposedAction();
-    if (event->mimeData()->hasFormat(mimeDataFormat()))
+    if (isTaskButtonDrag(event))
     {
         emit dragging(event->source(), event->pos());
         setAttribute(Qt::WA_UnderMouse, false);
@@ -206,7 +291,7 @@ void LXQtTaskButton::dragEnterEvent(QDragEnterEvent *event)
 
 void LXQtTaskButton::dragMoveEvent(QDragMoveEvent * event)
 {
-    if (event->mimeData()->hasFormat(mimeDataFormat()))
+    if (isTaskButtonDrag(event))
     {
         emit dragging(event->source(), event->pos());
         setAttribute(Qt::WA_UnderMouse, false);
@@ -222,7 +307,7 @@ void LXQtTaskButton::dragLeaveEvent(QDragLeaveEvent *event)
 void LXQtTaskButton::dropEvent(QDropEvent *event)
 {
     mDNDTimer->stop();
-    if (event->mimeData()->hasFormat(mimeDataFormat()))
+    if (isTaskButtonDrag(event))
     {
         emit dropped(event->source(), event->pos());
         setAttribute(Qt::WA_UnderMouse, false);
@@ -315,6 +400,16 @@ void LXQtTaskButton::wheelEvent(QWheelEvent* event)
     QToolButton::wheelEvent(event);
 }
 
+/************************************************
+
+ ************************************************/
+bool LXQtTaskButton::isTaskButtonDrag(QDropEvent const * event)
+{
+    if (sDraggging && qobject_cast<LXQtTaskButton *>(event->source()))
+        return true;
+    return event->mimeData()->hasFormat(mimeDataFormat());
+}
+
 /************************************************
 
  ************************************************/
@@ -359,6 +454,7 @@ void LXQtTaskButton::mouseMoveEvent(QMouseEvent* event)
 
     sDraggging = true;
     drag->exec();
+    parentTaskBar()->dragFinished();
 
     // if button is dropped out of panel (e.g. on desktop)
     // it is not deleted automatically by Qt
@@ -377,7 +473,7 @@ void LXQtTaskButton::mouseMoveEvent(QMouseEvent* event)
  ************************************************/
 bool LXQtTaskButton::isApplicationHidden() const
 {
-    return KWindowInfo(mWindow, NET::WMState).state() & NET::Hidden;
+    return backend()->windowState(mWindow) & NET::Hidden;
 }
 
 /************************************************
@@ -385,7 +481,7 @@ bool LXQtTaskButton::isApplicationHidden() const
  ************************************************/
 bool LXQtTaskButton::isApplicationActive() const
 {
-    return KWindowInfo(mWindow, {}).win() == KWindowSystem::activeWindow();
+    return mWindow == backend()->activeWindow();
 }
 
 /************************************************
@@ -396,7 +492,7 @@ void LXQtTaskButton::activateWithDraggable()
     // raise app in any time when there is a drag
     // in progress to allow drop it into an app
     raiseApplication();
-    KWindowSystem::forceActiveWindow(mWindow);
+    backend()->activateWindow(mWindow, true);
 }
 
 /************************************************
@@ -404,18 +500,18 @@ void LXQtTaskButton::activateWithDraggable()
  ************************************************/
 void LXQtTaskButton::raiseApplication()
 {
-    KWindowInfo info(mWindow, NET::WMDesktop | NET::WMState | NET::XAWMState);
-    if (parentTaskBar()->raiseOnCurrentDesktop() && info.isMinimized())
+    LXQtTaskBarBackend * const b = backend();
+    if (parentTaskBar()->raiseOnCurrentDesktop() && b->isMinimized(mWindow))
     {
-        KWindowSystem::setOnDesktop(mWindow, KWindowSystem::currentDesktop());
+        b->setWindowOnDesktop(mWindow, b->currentDesktop());
     }
     else
     {
-        int winDesktop = info.desktop();
-        if (winDesktop >= 0 && KWindowSystem::currentDesktop() != winDesktop)
-            KWindowSystem::setCurrentDesktop(winDesktop);
+        int winDesktop = b->windowDesktop(mWindow);
+        if (winDesktop >= 0 && b->currentDesktop() != winDesktop)
+            b->setCurrentDesktop(winDesktop);
     }
-    KWindowSystem::activateWindow(mWindow);
+    b->activateWindow(mWindow);
 
     setUrgencyHint(false);
 }
@@ -425,7 +521,7 @@ void LXQtTaskButton::raiseApplication()
  ************************************************/
 void LXQtTaskButton::minimizeApplication()
 {
-    KWindowSystem::minimizeWindow(mWindow);
+    backend()->minimizeWindow(mWindow);
 }
 
 /************************************************
@@ -441,15 +537,15 @@ void LXQtTaskButton::maximizeApplication()
     switch (state)
     {
         case NET::MaxHoriz:
-            KWindowSystem::setState(mWindow, NET::MaxHoriz);
+            backend()->setWindowState(mWindow, NET::MaxHoriz);
             break;
 
         case NET::MaxVert:
-            KWindowSystem::setState(mWindow, NET::MaxVert);
+            backend()->setWindowState(mWindow, NET::MaxVert);
             break;
 
         default:
-            KWindowSystem::setState(mWindow, NET::Max);
+            backend()->setWindowState(mWindow, NET::Max);
             break;
     }
 
@@ -462,7 +558,7 @@ void LXQtTaskButton::maximizeApplication()
  ************************************************/
 void LXQtTaskButton::deMaximizeApplication()
 {
-    KWindowSystem::clearState(mWindow, NET::Max);
+    backend()->clearWindowState(mWindow, NET::Max);
 
     if (!isApplicationActive())
         raiseApplication();
@@ -473,7 +569,7 @@ void LXQtTaskButton::deMaximizeApplication()
  ************************************************/
 void LXQtTaskButton::shadeApplication()
 {
-    KWindowSystem::setState(mWindow, NET::Shaded);
+    backend()->setWindowState(mWindow, NET::Shaded);
 }
 
 /************************************************
@@ -481,7 +577,7 @@ void LXQtTaskButton::shadeApplication()
  ************************************************/
 void LXQtTaskButton::unShadeApplication()
 {
-    KWindowSystem::clearState(mWindow, NET::Shaded);
+    backend()->clearWindowState(mWindow, NET::Shaded);
 }
 
 /************************************************
@@ -489,12 +585,12 @@ void LXQtTaskButton::unShadeApplication()
  ************************************************/
 void LXQtTaskButton::closeApplication()
 {
-    KWindowInfo(mWindow, NET::CloseWindow);
+    backend()->closeWindow(mWindow);
 }
 
 void LXQtTaskButton::closeProcess()
 {
-    if (pid_t pid = KWindowInfo(mWindow, NET::WMPid).pid())
+    if (pid_t pid = backend()->windowPid(mWindow))
         kill(pid, SIGTERM);
     else
         closeApplication();
@@ -513,18 +609,18 @@ void LXQtTaskButton::setApplicationLayer()
     switch(layer)
     {
         case NET::KeepAbove:
-            KWindowSystem::clearState(mWindow, NET::KeepBelow);
-            KWindowSystem::setState(mWindow, NET::KeepAbove);
+            backend()->clearWindowState(mWindow, NET::KeepBelow);
+            backend()->setWindowState(mWindow, NET::KeepAbove);
             break;
 
         case NET::KeepBelow:
-            KWindowSystem::clearState(mWindow, NET::KeepAbove);
-            KWindowSystem::setState(mWindow, NET::KeepBelow);
+            backend()->clearWindowState(mWindow, NET::KeepAbove);
+            backend()->setWindowState(mWindow, NET::KeepBelow);
             break;
 
         default:
-            KWindowSystem::clearState(mWindow, NET::KeepBelow);
-            KWindowSystem::clearState(mWindow, NET::KeepAbove);
+            backend()->clearWindowState(mWindow, NET::KeepBelow);
+            backend()->clearWindowState(mWindow, NET::KeepAbove);
             break;
     }
 }
@@ -544,7 +640,7 @@ void LXQtTaskButton::moveApplicationToDesktop()
     if (!ok)
         return;
 
-    KWindowSystem::setOnDesktop(mWindow, desk);
+    backend()->setWindowOnDesktop(mWindow, desk);
 }
 
 /************************************************
@@ -552,11 +648,11 @@ void LXQtTaskButton::moveApplicationToDesktop()
  ************************************************/
 void LXQtTaskButton::moveApplicationToPrevNextDesktop(bool next)
 {
-    int deskNum = KWindowSystem::numberOfDesktops();
+    int deskNum = backend()->numberOfDesktops();
     if (deskNum <= 1)
         return;
-    int targetDesk = KWindowInfo(mWindow, NET::WMDesktop).desktop();
-    targetDesk = (targetDesk < 0 ? KWindowSystem::currentDesktop()
+    int targetDesk = backend()->windowDesktop(mWindow);
+    targetDesk = (targetDesk < 0 ? backend()->currentDesktop()
                                  : targetDesk) + (next ? 1 : -1);
     // wrap around
     if (targetDesk > deskNum)
@@ -564,7 +660,7 @@ void LXQtTaskButton::moveApplicationToPrevNextDesktop(bool next)
     else if (targetDesk < 1)
         targetDesk = deskNum;
 
-    KWindowSystem::setOnDesktop(mWindow, targetDesk);
+    backend()->setWindowOnDesktop(mWindow, targetDesk);
 }
 
 /************************************************
@@ -572,13 +668,12 @@ void LXQtTaskButton::moveApplicationToPrevNextDesktop(bool next)
  ************************************************/
 void LXQtTaskButton::moveApplicationToPrevNextMonitor(bool next)
 {
-    KWindowInfo info(mWindow, NET::WMDesktop);
-    if (!info.isOnCurrentDesktop())
-        KWindowSystem::setCurrentDesktop(info.desktop());
+    if (!isOnDesktop(backend()->currentDesktop()))
+        backend()->setCurrentDesktop(backend()->windowDesktop(mWindow));
     if (isMinimized())
-        KWindowSystem::unminimizeWindow(mWindow);
-    KWindowSystem::forceActiveWindow(mWindow);
-    const QRect& windowGeometry = KWindowInfo(mWindow, NET::WMFrameExtents).frameGeometry();
+        backend()->unminimizeWindow(mWindow);
+    backend()->activateWindow(mWindow, true);
+    const QRect& windowGeometry = backend()->frameGeometry(mWindow);
     QList<QScreen *> screens = QGuiApplication::screens();
     if (screens.size() > 1){
         for (int i = 0; i < screens.size(); ++i)
@@ -594,13 +689,12 @@ void LXQtTaskButton::moveApplicationToPrevNextMonitor(bool next)
                 QRect targetScreenGeometry = screens[targetScreen]->geometry();
                 int X = windowGeometry.x() - screenGeometry.x() + targetScreenGeometry.x();
                 int Y = windowGeometry.y() - screenGeometry.y() + targetScreenGeometry.y();
-                KWindowInfo info(mWindow, NET::WMState | NET::WMGeometry, NET::WM2MoveResizeWindow);
-                const NET::States &state = info.state();
-                KWindowSystem::clearState(mWindow, NET::MaxHoriz | NET::MaxVert | NET::Max | NET::FullScreen);
-                info.setPosition(X, Y);
+                const NET::States state = backend()->windowState(mWindow);
+                backend()->clearWindowState(mWindow, NET::MaxHoriz | NET::MaxVert | NET::Max | NET::FullScreen);
+                KWindowInfo(mWindow, NET::WMState | NET::WMGeometry, NET::WM2MoveResizeWindow).setPosition(X, Y);
                 QTimer::singleShot(200, this, [this, state]
                 {
-                    KWindowSystem::setState(mWindow, state);
+                    backend()->setWindowState(mWindow, state);
                     raiseApplication();
                 });
                 break;
@@ -630,7 +724,7 @@ void LXQtTaskButton::finishMoveResize(QObject *obj)
  ************************************************/
 void LXQtTaskButton::moveApplication()
 {
-    KWindowSystem::forceActiveWindow(mWindow);
+    backend()->activateWindow(mWindow, true);
     mWMMoveResize = NET::Move;
 }
 
@@ -639,9 +733,9 @@ void LXQtTaskButton::moveApplication()
  ************************************************/
 void LXQtTaskButton::resizeApplication()
 {
-    KWindowSystem::setState(mWindow, NET::Hidden | NET::Focused);
-    KWindowSystem::clearState(mWindow, NET::Hidden);
-    KWindowSystem::forceActiveWindow(mWindow);
+    backend()->setWindowState(mWindow, NET::Hidden | NET::Focused);
+    backend()->clearWindowState(mWindow, NET::Hidden);
+    backend()->activateWindow(mWindow, true);
     mWMMoveResize = static_cast<NET::Direction>(-1);
 }
 
@@ -656,13 +750,9 @@ void LXQtTaskButton::contextMenuEvent(QContextMenuEvent* event)
         return;
     }
 
-    KWindowInfo info(mWindow,
-                     NET::Properties() | NET::WMState | NET::XAWMState,
-                     NET::WM2AllowedActions);
-    NET::States state = info.state();
-
-    if (!info.isMinimized())
-        state &= ~NET::Hidden;
+    LXQtTaskBarBackend * const b = backend();
+    NET::States state;
+    const NET::Actions actions = b->windowActions(mWindow, state);
 
     QMenu* menu = new QMenu(tr("Application"), mParentTaskBar);
     menu->setAttribute(Qt::WA_DeleteOnClose);
@@ -696,10 +786,10 @@ void LXQtTaskButton::contextMenuEvent(QContextMenuEvent* event)
     */
 
     /********** Desktop menu **********/
-    int deskNum = KWindowSystem::numberOfDesktops();
+    int deskNum = b->numberOfDesktops();
     if (deskNum > 1)
     {
-        int winDesk = KWindowInfo(mWindow, NET::WMDesktop).desktop();
+        int winDesk = b->windowDesktop(mWindow);
         QMenu* deskMenu = menu->addMenu(tr("To &Desktop"));
 
         a = deskMenu->addAction(tr("&All Desktops"));
@@ -710,7 +800,7 @@ void LXQtTaskButton::contextMenuEvent(QContextMenuEvent* event)
 
         for (int i = 0; i < deskNum; ++i)
         {
-            const auto &deskName = KWindowSystem::desktopName(i).trimmed();
+            const auto &deskName = b->desktopName(i).trimmed();
 
             a = deskMenu->addAction(
                 deskName.isEmpty() ? tr("Desktop &%1").arg(i + 1)
@@ -721,7 +811,7 @@ void LXQtTaskButton::contextMenuEvent(QContextMenuEvent* event)
             connect(a, &QAction::triggered, this, &LXQtTaskButton::moveApplicationToDesktop);
         }
 
-        int curDesk = KWindowSystem::currentDesktop();
+        int curDesk = b->currentDesktop();
         a = menu->addAction(tr("&To Current Desktop"));
         a->setData(curDesk);
         a->setEnabled(curDesk != winDesk);
@@ -733,9 +823,9 @@ void LXQtTaskButton::contextMenuEvent(QContextMenuEvent* event)
         menu->addSeparator();
         a = menu->addAction(tr("Move To N&ext Monitor"));
         connect(a, &QAction::triggered, this, [this] { moveApplicationToPrevNextMonitor(true); });
-        a->setEnabled(info.isOnCurrentDesktop() &&
-                      info.actionSupported(NET::ActionMove) &&
-                      (!(state & NET::FullScreen) || info.actionSupported(NET::ActionFullScreen)));
+        a->setEnabled(isOnDesktop(b->currentDesktop()) &&
+                      actions.testFlag(NET::ActionMove) &&
+                      (!(state & NET::FullScreen) || actions.testFlag(NET::ActionFullScreen)));
         a = menu->addAction(tr("Move To &Previous Monitor"));
         connect(a, &QAction::triggered, this, [this] { moveApplicationToPrevNextMonitor(false); });
     }
@@ -743,12 +833,12 @@ void LXQtTaskButton::contextMenuEvent(QContextMenuEvent* event)
     connect(menu, &QObject::destroyed, this, &LXQtTaskButton::finishMoveResize);
     a = menu->addAction(tr("&Move"));
     a->setEnabled(//info.isOnCurrentDesktop() &&
-                  info.actionSupported(NET::ActionMove) &&
+                  actions.testFlag(NET::ActionMove) &&
                   !(state & (NET::Max | NET::FullScreen)));
     connect(a, &QAction::triggered, this, &LXQtTaskButton::moveApplication);
     a = menu->addAction(tr("Resi&ze"));
     a->setEnabled(//info.isOnCurrentDesktop() &&
-                  info.actionSupported(NET::ActionResize) &&
+                  actions.testFlag(NET::ActionResize) &&
                   !(state & (NET::Max | NET::FullScreen)));
     connect(a, &QAction::triggered, this, &LXQtTaskButton::resizeApplication);
 
@@ -756,19 +846,19 @@ void LXQtTaskButton::contextMenuEvent(QContextMenuEvent* event)
     menu->addSeparator();
 
     a = menu->addAction(tr("Ma&ximize"));
-    a->setEnabled(info.actionSupported(NET::ActionMax) && (!(state & NET::Max) || (state & NET::Hidden)));
+    a->setEnabled(actions.testFlag(NET::ActionMax) && (!(state & NET::Max) || (state & NET::Hidden)));
     a->setData(NET::Max);
     connect(a, &QAction::triggered, this, &LXQtTaskButton::maximizeApplication);
 
     if (event->modifiers() & Qt::ShiftModifier)
     {
         a = menu->addAction(tr("Maximize vertically"));
-        a->setEnabled(info.actionSupported(NET::ActionMaxVert) && !((state & NET::MaxVert) || (state & NET::Hidden)));
+        a->setEnabled(actions.testFlag(NET::ActionMaxVert) && !((state & NET::MaxVert) || (state & NET::Hidden)));
         a->setData(NET::MaxVert);
         connect(a, &QAction::triggered, this, &LXQtTaskButton::maximizeApplication);
 
         a = menu->addAction(tr("Maximize horizontally"));
-        a->setEnabled(info.actionSupported(NET::ActionMaxHoriz) && !((state & NET::MaxHoriz) || (state & NET::Hidden)));
+        a->setEnabled(actions.testFlag(NET::ActionMaxHoriz) && !((state & NET::MaxHoriz) || (state & NET::Hidden)));
         a->setData(NET::MaxHoriz);
         connect(a, &QAction::triggered, this, &LXQtTaskButton::maximizeApplication);
     }
@@ -778,19 +868,19 @@ void LXQtTaskButton::contextMenuEvent(QContextMenuEvent* event)
     connect(a, &QAction::triggered, this, &LXQtTaskButton::deMaximizeApplication);
 
     a = menu->addAction(tr("Mi&nimize"));
-    a->setEnabled(info.actionSupported(NET::ActionMinimize) && !(state & NET::Hidden));
+    a->setEnabled(actions.testFlag(NET::ActionMinimize) && !(state & NET::Hidden));
     connect(a, &QAction::triggered, this, &LXQtTaskButton::minimizeApplication);
 
     if (state & NET::Shaded)
     {
         a = menu->addAction(tr("Roll down"));
-        a->setEnabled(info.actionSupported(NET::ActionShade) && !(state & NET::Hidden));
+        a->setEnabled(actions.testFlag(NET::ActionShade) && !(state & NET::Hidden));
         connect(a, &QAction::triggered, this, &LXQtTaskButton::unShadeApplication);
     }
     else
     {
         a = menu->addAction(tr("Roll up"));
-        a->setEnabled(info.actionSupported(NET::ActionShade) && !(state & NET::Hidden));
+        a->setEnabled(actions.testFlag(NET::ActionShade) && !(state & NET::Hidden));
         connect(a, &QAction::triggered, this, &LXQtTaskButton::shadeApplication);
     }
 
@@ -857,7 +947,7 @@ void LXQtTaskButton::setUrgencyHint(bool set)
         return;
 
     if (!set)
-        KWindowSystem::demandAttention(mWindow, false);
+        backend()->demandAttention(mWindow, false);
 
     mUrgencyHint = set;
     setProperty("urgent", set);
@@ -869,19 +959,57 @@ void LXQtTaskButton::setUrgencyHint(bool set)
 /************************************************
 
  ************************************************/
+LXQtTaskBarBackend * LXQtTaskButton::backend() const
+{
+    return mParentTaskBar->backend();
+}
+
 bool LXQtTaskButton::isOnDesktop(int desktop) const
 {
-    return KWindowInfo(mWindow, NET::WMDesktop).isOnDesktop(desktop);
+    return backend()->isOnDesktop(mWindow, desktop);
 }
 
 bool LXQtTaskButton::isOnCurrentScreen() const
 {
-    return QApplication::desktop()->screenGeometry(parentTaskBar()).intersects(KWindowInfo(mWindow, NET::WMFrameExtents).frameGeometry());
+    // the screen layout changed since the last check
+    if (mScreenEpoch != parentTaskBar()->screenEpoch())
+    {
+        mScreenMask = calculateScreenMask();
+        mScreenEpoch = parentTaskBar()->screenEpoch();
+    }
+    const int screen = parentTaskBar()->currentScreen();
+    return 0 <= screen && screen < 32 && (mScreenMask & (1u << screen));
+}
+
+bool LXQtTaskButton::updateScreens()
+{
+    const quint32 mask = calculateScreenMask();
+    const bool changed = mScreenMask != mask || mScreenEpoch != parentTaskBar()->screenEpoch();
+    mScreenMask = mask;
+    mScreenEpoch = parentTaskBar()->screenEpoch();
+    return changed;
+}
+
+quint32 LXQtTaskButton::calculateScreenMask() const
+{
+    return screenMask(backend()->frameGeometry(mWindow));
+}
+
+quint32 LXQtTaskButton::screenMask(QRect const & frame)
+{
+    const QList<QScreen *> screens = QGuiApplication::screens();
+    quint32 mask = 0;
+    for (int i = 0, i_e = qMin(screens.size(), 32); i < i_e; ++i)
+    {
+        if (screens[i]->geometry().intersects(frame))
+            mask |= 1u << i;
+    }
+    return mask;
 }
 
 bool LXQtTaskButton::isMinimized() const
 {
-    return KWindowInfo(mWindow,NET::WMState | NET::XAWMState).isMinimized();
+    return backend()->isMinimized(mWindow);
 }
 
 Qt::Corner LXQtTaskButton::origin() const
@@ -924,6 +1052,26 @@ void LXQtTaskButton::setAutoRotation(bool value, ILXQtPanel::Position position)
 
 void LXQtTaskButton::paintEvent(QPaintEvent *event)
 {
+    if (mThumbnailArea.isValid())
+    {
+        // the thumbnail on top, the ordinary contents below it
+        // (buttons with thumbnails live in the group popup, they are never rotated)
+        QStylePainter painter(this);
+        QStyleOptionToolButton opt;
+        initStyleOption(&opt);
+        const int areaHeight = mThumbnailArea.height() + thumbnailMargin();
+        opt.rect.setTop(opt.rect.top() + areaHeight);
+        painter.drawComplexControl(QStyle::CC_ToolButton, opt);
+        if (!mThumbnail.isNull())
+        {
+            const QSize thumbnailSize = mThumbnail.size() / mThumbnail.devicePixelRatio();
+            const QPoint topLeft{(width() - thumbnailSize.width()) / 2
+                , thumbnailMargin() + (mThumbnailArea.height() - thumbnailSize.height()) / 2};
+            painter.drawImage(QRect{topLeft, thumbnailSize}, mThumbnail);
+        }
+        return;
+    }
+
     if (mOrigin == Qt::TopLeftCorner)
     {
         QToolButton::paintEvent(event);
@@ -33,14 +33,18 @@
 
 #include <QToolButton>
 #include <QProxyStyle>
+#include <QFont>
+#include <QImage>
 #include <netwm_def.h>
 #include "../panel/ilxqtpanel.h"
 
 class QPainter;
 class QPalette;
 class QMimeData;
+class QDropEvent;
 class LXQtTaskGroup;
 class LXQtTaskBar;
+class LXQtTaskBarBackend;
 
 class LeftAlignedTextStyle : public QProxyStyle
 {
@@ -72,16 +76,44 @@ public:
 
     bool isOnDesktop(int desktop) const;
     bool isOnCurrentScreen() const;
+    /*! Updates the cached screens the window is placed on.
+     * \return true if the window moved onto/out of some screen
+     */
+    bool updateScreens();
     bool isMinimized() const;
     void updateText();
+    //! applies the text change postponed by the rate limiting (if any)
+    void flushText();
+
+    /*! \return the button text elided to the given width (cached for the last font & width)
+     */
+    QString const & elidedText(QFont const & font, int width) const;
+
+    /*! Sets the window thumbnail shown above the ordinary button contents.
+     * \param area size reserved for the thumbnail (invalid size switches the thumbnail off)
+     */
+    void setThumbnail(QImage const & thumbnail, QSize const & area);
+    //! space between the thumbnail and the button border
+    static int thumbnailMargin() { return 3; }
+
+    QSize sizeHint() const override;
 
     Qt::Corner origin() const;
     virtual void setAutoRotation(bool value, ILXQtPanel::Position position);
 
     LXQtTaskBar * parentTaskBar() const {return mParentTaskBar;}
+    LXQtTaskBarBackend * backend() const;
 
     void refreshIconGeometry(QRect const & geom);
     static QString mimeDataFormat() { return QLatin1String("lxqt/lxqttaskbutton"); }
+    /*! \return true if a task button is being dragged (the in-process drags
+     * are recognized by their source, without looking into the mime data)
+     */
+    static bool isTaskButtonDrag(QDropEvent const * event);
+    //! \return true if a task button is being dragged right now
+    static bool isDragging() { return sDraggging; }
+    //! \return the screens (bit per screen) the window frame intersects
+    static quint32 screenMask(QRect const & frame);
     /*! \return true if this buttom received DragEnter event (and no DragLeave event yet)
      * */
     bool hasDragAndDropHover() const;
@@ -127,6 +159,7 @@ protected:
 private:
     void moveApplicationToPrevNextDesktop(bool next);
     void moveApplicationToPrevNextMonitor(bool next);
+    quint32 calculateScreenMask() const;
     WId mWindow;
     NET::Direction mWMMoveResize;
     bool mUrgencyHint;
@@ -144,8 +177,27 @@ private:
     // Timer for distinguishing between separate mouse wheel rotations
     QTimer * mWheelTimer;
 
+    // Timer for limiting the rate of text updates (some applications change
+    // the title many times per second)
+    QTimer * mTextTimer;
+    bool mTextPending;
+
+    // cache of the elided text
+    mutable QString mElidedText;
+    mutable QString mElidedSource;
+    mutable QFont mElidedFont;
+    mutable int mElidedWidth;
+
+    // cache of the screens the window intersects (bit per screen, valid for mScreenEpoch of the taskbar)
+    mutable quint32 mScreenMask;
+    mutable int mScreenEpoch;
+
+    QImage mThumbnail;
+    QSize mThumbnailArea;
+
 private slots:
     void activateWithDraggable();
+    void applyText();
 
 signals:
     void dropped(QObject * dragSource, QPoint const & pos);
@@ -30,6 +30,8 @@
 
 #include "lxqttaskgroup.h"
 #include "lxqttaskbar.h"
+#include "lxqttaskthumbnailer.h"
+#include "lxqttaskbarbackend.h"
 
 #include <QDebug>
 #include <QMimeData>
@@ -37,8 +39,8 @@
 #include <QDragLeaveEvent>
 #include <QStringBuilder>
 #include <QMenu>
+#include <QPainter>
 #include <XdgIcon>
-#include <KF5/KWindowSystem/KWindowSystem>
 #include <functional>
 
 /************************************************
@@ -49,16 +51,19 @@ LXQtTaskGroup::LXQtTaskGroup(const QString &groupName, WId window, LXQtTaskBar *
     mGroupName(groupName),
     mPopup(new LXQtGroupPopup(this)),
     mPreventPopup(false),
-    mSingleButton(true)
+    mSingleButton(true),
+    mShownByFilter(false),
+    mVisibleCount(0)
 {
     Q_ASSERT(parent);
 
+    mAppId = LXQtTaskBar::launcherAppId(QString::fromUtf8(backend()->windowClass(window)));
+
     setObjectName(groupName);
     setText(groupName);
 
     connect(this,                  &LXQtTaskGroup::clicked,               this, &LXQtTaskGroup::onClicked);
-    connect(KWindowSystem::self(), &KWindowSystem::currentDesktopChanged, this, &LXQtTaskGroup::onDesktopChanged);
-    connect(KWindowSystem::self(), &KWindowSystem::activeWindowChanged,   this, &LXQtTaskGroup::onActiveWindowChanged);
+    connect(parent->backend(),     &LXQtTaskBarBackend::activeWindowChanged, this, &LXQtTaskGroup::onActiveWindowChanged);
     connect(parent,                &LXQtTaskBar::buttonRotationRefreshed, this, &LXQtTaskGroup::setAutoRotation);
     connect(parent,                &LXQtTaskBar::refreshIconGeometry,     this, &LXQtTaskGroup::refreshIconsGeometry);
     connect(parent,                &LXQtTaskBar::buttonStyleRefreshed,    this, &LXQtTaskGroup::setToolButtonsStyle);
@@ -90,9 +95,9 @@ void LXQtTaskGroup::contextMenuEvent(QContextMenuEvent *event)
     connect(b, &QAction::triggered, this, &LXQtTaskGroup::minimizeGroup);
     for (LXQtTaskButton *button : qAsConst(mButtonHash) )
     {
-        KWindowInfo info(button->windowId(), NET::WMState | NET::XAWMState);
-        if (info.actionSupported(NET::ActionMinimize))
-            (info.isMinimized() ? a : b)->setEnabled(true);
+        NET::States state;
+        if (backend()->windowActions(button->windowId(), state).testFlag(NET::ActionMinimize))
+            (state.testFlag(NET::Hidden) ? a : b)->setEnabled(true);
     }
     a = menu->addAction(XdgIcon::fromTheme(QStringLiteral("process-stop")), tr("Close group"));
     connect(a,    &QAction::triggered, this, &LXQtTaskGroup::closeGroup);
@@ -113,8 +118,8 @@ void LXQtTaskGroup::contextMenuEvent(QContextMenuEvent *event)
 void LXQtTaskGroup::unminimizeGroup()
 {
     for (LXQtTaskButton *button : qAsConst(mButtonHash) )
-        if (button->isOnDesktop(KWindowSystem::currentDesktop()))
-            KWindowSystem::unminimizeWindow(button->windowId());
+        if (button->isOnDesktop(backend()->currentDesktop()))
+            backend()->unminimizeWindow(button->windowId());
 }
 
 /************************************************
@@ -123,7 +128,7 @@ void LXQtTaskGroup::unminimizeGroup()
 void LXQtTaskGroup::minimizeGroup()
 {
     for (LXQtTaskButton *button : qAsConst(mButtonHash) )
-        if (button->isOnDesktop(KWindowSystem::currentDesktop()))
+        if (button->isOnDesktop(backend()->currentDesktop()))
             button->minimizeApplication();
 }
 
@@ -133,7 +138,7 @@ void LXQtTaskGroup::minimizeGroup()
 void LXQtTaskGroup::closeGroup()
 {
     for (LXQtTaskButton *button : qAsConst(mButtonHash) )
-        if (button->isOnDesktop(KWindowSystem::currentDesktop()))
+        if (button->isOnDesktop(backend()->currentDesktop()))
             button->closeApplication();
 }
 
@@ -158,7 +163,11 @@ LXQtTaskButton * LXQtTaskGroup::addWindow(WId id)
     mPopup->addButton(btn);
 
     connect(btn, &LXQtTaskButton::clicked, this, &LXQtTaskGroup::onChildButtonClicked);
-    refreshVisibility();
+    const bool visible = isShownByFilters(btn);
+    btn->setVisible(visible);
+    if (visible)
+        ++mVisibleCount;
+    applyVisibility();
 
     return btn;
 }
@@ -178,47 +187,16 @@ LXQtTaskButton * LXQtTaskGroup::checkedButton() const
 /************************************************
 
  ************************************************/
-LXQtTaskButton * LXQtTaskGroup::getNextPrevChildButton(bool next, bool circular)
+QList<LXQtTaskButton *> LXQtTaskGroup::visibleChildButtons() const
 {
-    LXQtTaskButton *button = checkedButton();
-    int idx = mPopup->indexOf(button);
-    int inc = next ? 1 : -1;
-    idx += inc;
-
-    // if there is no cheked button, get the first one if next equals true
-    // or the last one if not
-    if (!button)
+    QList<LXQtTaskButton *> buttons;
+    for (int i = 0; i < mPopup->count(); i++)
     {
-        idx = -1;
-        if (next)
-        {
-            for (int i = 0; i < mPopup->count() && idx == -1; i++)
-                if (mPopup->itemAt(i)->widget()->isVisibleTo(mPopup))
-                    idx = i;
-        }
-        else
-        {
-            for (int i = mPopup->count() - 1; i >= 0 && idx == -1; i--)
-                if (mPopup->itemAt(i)->widget()->isVisibleTo(mPopup))
-                    idx = i;
-        }
+        LXQtTaskButton * button = qobject_cast<LXQtTaskButton*>(mPopup->itemAt(i)->widget());
+        if (button && button->isVisibleTo(mPopup))
+            buttons.append(button);
     }
-
-    if (circular)
-        idx = (idx + mButtonHash.count()) % mButtonHash.count();
-    else if (mPopup->count() <= idx || idx < 0)
-        return nullptr;
-
-    // return the next or the previous child
-    QLayoutItem *item = mPopup->itemAt(idx);
-    if (item)
-    {
-        button = qobject_cast<LXQtTaskButton*>(item->widget());
-        if (button->isVisibleTo(mPopup))
-            return button;
-    }
-
-    return nullptr;
+    return buttons;
 }
 
 /************************************************
@@ -239,14 +217,6 @@ void LXQtTaskGroup::onActiveWindowChanged(WId window)
     setChecked(nullptr != button);
 }
 
-/************************************************
-
- ************************************************/
-void LXQtTaskGroup::onDesktopChanged(int /*number*/)
-{
-    refreshVisibility();
-}
-
 /************************************************
 
  ************************************************/
@@ -256,6 +226,8 @@ void LXQtTaskGroup::onWindowRemoved(WId window)
     {
         LXQtTaskButton *button = mButtonHash.value(window);
         mButtonHash.remove(window);
+        if (button->isVisibleTo(mPopup))
+            --mVisibleCount;
         mPopup->removeWidget(button);
         button->deleteLater();
 
@@ -263,9 +235,11 @@ void LXQtTaskGroup::onWindowRemoved(WId window)
             regroup();
         else
         {
-            if (isVisible())
-                emit visibilityChanged(false);
+            const bool was = mShownByFilter;
+            mShownByFilter = false;
             hide();
+            if (was)
+                emit visibilityChanged(false);
             emit groupBecomeEmpty(groupName());
 
         }
@@ -313,18 +287,6 @@ int LXQtTaskGroup::buttonsCount() const
     return mButtonHash.count();
 }
 
-/************************************************
-
- ************************************************/
-int LXQtTaskGroup::visibleButtonsCount() const
-{
-    int i = 0;
-    for (LXQtTaskButton *btn : qAsConst(mButtonHash))
-        if (btn->isVisibleTo(mPopup))
-            i++;
-    return i;
-}
-
 /************************************************
 
  ************************************************/
@@ -341,7 +303,7 @@ void LXQtTaskGroup::onClicked(bool)
 {
     if (visibleButtonsCount() > 1)
     {
-        setChecked(mButtonHash.contains(KWindowSystem::activeWindow()));
+        setChecked(mButtonHash.contains(backend()->activeWindow()));
         setPopupVisible(true);
     }
 }
@@ -376,7 +338,15 @@ void LXQtTaskGroup::regroup()
         }
     }
     else if (cont == 0)
+    {
         hide();
+        if (mShownByFilter)
+        {
+            // the last shown window was removed
+            mShownByFilter = false;
+            emit visibilityChanged(false);
+        }
+    }
     else
     {
         mSingleButton = false;
@@ -413,28 +383,88 @@ void LXQtTaskGroup::setAutoRotation(bool value, ILXQtPanel::Position position)
 /************************************************
 
  ************************************************/
-void LXQtTaskGroup::refreshVisibility()
+bool LXQtTaskGroup::isShownByFilters(LXQtTaskButton * btn) const
 {
-    bool will = false;
     LXQtTaskBar const * taskbar = parentTaskBar();
     const int showDesktop = taskbar->showDesktopNum();
+    bool visible = taskbar->isShowOnlyOneDesktopTasks() ? btn->isOnDesktop(0 == showDesktop ? backend()->currentDesktop() : showDesktop) : true;
+    visible &= taskbar->isShowOnlyCurrentScreenTasks() ? btn->isOnCurrentScreen() : true;
+    visible &= taskbar->isShowOnlyMinimizedTasks() ? btn->isMinimized() : true;
+    return visible;
+}
+
+/************************************************
+
+ ************************************************/
+bool LXQtTaskGroup::refreshVisibility()
+{
+    mVisibleCount = 0;
     for(LXQtTaskButton * btn : qAsConst(mButtonHash))
     {
-        bool visible = taskbar->isShowOnlyOneDesktopTasks() ? btn->isOnDesktop(0 == showDesktop ? KWindowSystem::currentDesktop() : showDesktop) : true;
-        visible &= taskbar->isShowOnlyCurrentScreenTasks() ? btn->isOnCurrentScreen() : true;
-        visible &= taskbar->isShowOnlyMinimizedTasks() ? btn->isMinimized() : true;
+        const bool visible = isShownByFilters(btn);
         btn->setVisible(visible);
-        will |= visible;
+        if (visible)
+            ++mVisibleCount;
     }
+    return applyVisibility();
+}
+
+/************************************************
 
-    bool is = isVisible();
+ ************************************************/
+bool LXQtTaskGroup::applyVisibility()
+{
+    const bool will = 0 < mVisibleCount;
+    const bool is = mShownByFilter;
+    mShownByFilter = will;
     setVisible(will);
     regroup();
 
     if (is != will)
         emit visibilityChanged(will);
+    return is != will;
+}
+
+/************************************************
+ Badges: number of windows (of a real group) and the progress
+ announced by the application
+ ************************************************/
+void LXQtTaskGroup::paintEvent(QPaintEvent * event)
+{
+    LXQtTaskButton::paintEvent(event);
+
+    LXQtTaskBar * const taskbar = parentTaskBar();
+    if (!taskbar->isShowBadges())
+        return;
+
+    const double progress = taskbar->launcherProgress(mAppId);
+    const bool showCount = taskbar->isGroupingEnabled() && 1 < mVisibleCount;
+    if (!showCount && 0 > progress)
+        return;
+
+    QPainter painter(this);
+    if (0 <= progress)
+    {
+        const int h = qMax(2, height() / 12);
+        QRect bar{0, height() - h, width(), h};
+        painter.fillRect(bar, palette().color(QPalette::Mid));
+        const int done = qRound(bar.width() * progress);
+        if (isRightToLeft())
+            bar.setLeft(bar.right() - done + 1);
+        else
+            bar.setWidth(done);
+        painter.fillRect(bar, palette().color(QPalette::Highlight));
+    }
+    if (showCount)
+    {
+        const QPixmap badge = taskbar->badgePixmap(mVisibleCount, qMax(8, iconSize().height() / 2), devicePixelRatioF());
+        const QSize badgeSize = badge.size() / badge.devicePixelRatio();
+        const QPoint topLeft{isRightToLeft() ? 1 : width() - badgeSize.width() - 1, 1};
+        painter.drawPixmap(topLeft, badge);
+    }
 }
 
+
 /************************************************
 
  ************************************************/
@@ -517,6 +547,8 @@ int LXQtTaskGroup::recalculateFrameHeight() const
 {
     int cont = visibleButtonsCount();
     int h = !plugin()->panel()->isHorizontal() && parentTaskBar()->isAutoRotate() ? width() : height();
+    if (LXQtTaskThumbnailer const * thumbnailer = parentTaskBar()->thumbnailer())
+        h += thumbnailer->thumbnailSize().height() + LXQtTaskButton::thumbnailMargin();
     return cont * h + (cont + 1) * mPopup->spacing();
 }
 
@@ -530,7 +562,10 @@ int LXQtTaskGroup::recalculateFrameWidth() const
     int txtWidth = 0;
     for (LXQtTaskButton *btn : qAsConst(mButtonHash))
         txtWidth = qMax(fm.horizontalAdvance(btn->text()), txtWidth);
-    return iconSize().width() + qMin(txtWidth, max) + 30/* give enough room to margins and borders*/;
+    int frameWidth = iconSize().width() + qMin(txtWidth, max) + 30/* give enough room to margins and borders*/;
+    if (LXQtTaskThumbnailer const * thumbnailer = parentTaskBar()->thumbnailer())
+        frameWidth = qMax(frameWidth, thumbnailer->thumbnailSize().width() + 2 * LXQtTaskButton::thumbnailMargin() + 30);
+    return frameWidth;
 }
 
 /************************************************
@@ -591,7 +626,7 @@ void LXQtTaskGroup::enterEvent(QEvent *event)
 void LXQtTaskGroup::dragEnterEvent(QDragEnterEvent *event)
 {
     // only show the popup if we aren't dragging a taskgroup
-    if (!event->mimeData()->hasFormat(mimeDataFormat()))
+    if (!isTaskButtonDrag(event))
     {
         setPopupVisible(true);
     }
@@ -647,6 +682,19 @@ void LXQtTaskGroup::wheelEvent(QWheelEvent* event)
     QToolButton::wheelEvent(event);
 }
 
+/************************************************
+
+ ************************************************/
+void LXQtTaskGroup::setUrgencyHint(WId window, bool set)
+{
+    if (LXQtTaskButton * const button = mButtonHash.value(window))
+        button->setUrgencyHint(set);
+
+    // If group is based on that window properties must be changed also on button group
+    if (windowId() == window)
+        LXQtTaskButton::setUrgencyHint(set);
+}
+
 /************************************************
 
  ************************************************/
@@ -658,7 +706,7 @@ bool LXQtTaskGroup::onWindowChanged(WId window, NET::Properties prop, NET::Prope
         buttons.append(mButtonHash.value(window));
 
     // If group is based on that window properties must be changed also on button group
-    if (KWindowInfo(windowId(), {}).win() == window)
+    if (windowId() == window)
         buttons.append(this);
 
     if (!buttons.isEmpty())
@@ -668,23 +716,27 @@ bool LXQtTaskGroup::onWindowChanged(WId window, NET::Properties prop, NET::Prope
             needsRefreshVisibility = true;
 
         // if class is changed the window won't belong to our group any more
-        if (parentTaskBar()->isGroupingEnabled() && prop2.testFlag(NET::WM2WindowClass))
+        if (prop2.testFlag(NET::WM2WindowClass))
         {
-            KWindowInfo info(window, NET::Properties(), NET::WM2WindowClass);
-            if (QString::fromUtf8(info.windowClassClass()) != mGroupName)
+            const QString window_class = QString::fromUtf8(backend()->windowClass(window));
+            if (parentTaskBar()->isGroupingEnabled() && window_class != mGroupName)
             {
                 onWindowRemoved(window);
                 return false;
             }
+            if (windowId() == window)
+                mAppId = LXQtTaskBar::launcherAppId(window_class);
         }
         // window changed virtual desktop
-        if (prop.testFlag(NET::WMDesktop) || prop.testFlag(NET::WMGeometry))
+        if (prop.testFlag(NET::WMDesktop) && parentTaskBar()->isShowOnlyOneDesktopTasks())
+            needsRefreshVisibility = true;
+
+        // moving/resizing within a screen doesn't affect the visibility
+        if (prop.testFlag(NET::WMGeometry) && parentTaskBar()->isShowOnlyCurrentScreenTasks())
         {
-            if (parentTaskBar()->isShowOnlyOneDesktopTasks()
-                    || parentTaskBar()->isShowOnlyCurrentScreenTasks())
-            {
+            LXQtTaskButton * const button = mButtonHash.value(window);
+            if (button && button->updateScreens())
                 needsRefreshVisibility = true;
-            }
         }
 
         if (prop.testFlag(NET::WMVisibleName) || prop.testFlag(NET::WMName))
@@ -697,10 +749,14 @@ bool LXQtTaskGroup::onWindowChanged(WId window, NET::Properties prop, NET::Prope
 
         if (prop.testFlag(NET::WMState))
         {
-            KWindowInfo info{window, NET::WMState};
-            if (info.hasState(NET::SkipTaskbar))
+            const NET::States state = backend()->windowState(window);
+            if (state.testFlag(NET::SkipTaskbar))
+            {
                 onWindowRemoved(window);
-            std::for_each(buttons.begin(), buttons.end(), std::bind(&LXQtTaskButton::setUrgencyHint, std::placeholders::_1, info.hasState(NET::DemandsAttention)));
+                // the last window gone -> the group is being deleted
+                if (mButtonHash.isEmpty())
+                    return true;
+            }
 
             if (parentTaskBar()->isShowOnlyMinimizedTasks())
             {
@@ -710,7 +766,7 @@ bool LXQtTaskGroup::onWindowChanged(WId window, NET::Properties prop, NET::Prope
     }
 
     if (needsRefreshVisibility)
-        refreshVisibility();
+        parentTaskBar()->requestRefreshVisibility(this);
 
     return true;
 }
@@ -52,26 +52,34 @@ public:
     LXQtTaskGroup(const QString & groupName, WId window, LXQtTaskBar * parent);
 
     QString groupName() const { return mGroupName; }
+    //! \return id of the application (for matching with the launcher entries)
+    QString appId() const { return mAppId; }
 
     int buttonsCount() const;
-    int visibleButtonsCount() const;
+    int visibleButtonsCount() const { return mVisibleCount; }
 
     LXQtTaskButton * addWindow(WId id);
     LXQtTaskButton * checkedButton() const;
 
-    // Returns the next or the previous button in the popup
-    // if circular is true, then it will go around the list of buttons
-    LXQtTaskButton * getNextPrevChildButton(bool next, bool circular);
+    // Returns the buttons of windows passing the filters (in the popup order)
+    QList<LXQtTaskButton *> visibleChildButtons() const;
 
     bool onWindowChanged(WId window, NET::Properties prop, NET::Properties2 prop2);
+    //! sets the urgency hint of the window's button(s)
+    void setUrgencyHint(WId window, bool set);
     void setAutoRotation(bool value, ILXQtPanel::Position position);
     Qt::ToolButtonStyle popupButtonStyle() const;
     void setToolButtonsStyle(Qt::ToolButtonStyle style);
 
     void setPopupVisible(bool visible = true, bool fast = false);
 
+    //! \return true if the group passes the "show only" filters of the taskbar
+    bool isShownByFilter() const { return mShownByFilter; }
+
 public slots:
     void onWindowRemoved(WId window);
+    //! \return true if the group got shown/hidden
+    bool refreshVisibility();
 
 protected:
     QMimeData * mimeData();
@@ -84,6 +92,7 @@ protected:
     void mouseMoveEvent(QMouseEvent * event);
     void mouseReleaseEvent(QMouseEvent *event);
     void wheelEvent(QWheelEvent* event);
+    void paintEvent(QPaintEvent * event);
     int recalculateFrameHeight() const;
     int recalculateFrameWidth() const;
 
@@ -93,13 +102,11 @@ private slots:
     void onClicked(bool checked);
     void onChildButtonClicked();
     void onActiveWindowChanged(WId window);
-    void onDesktopChanged(int number);
 
     void unminimizeGroup();
     void minimizeGroup();
     void closeGroup();
     void refreshIconsGeometry();
-    void refreshVisibility();
     void groupPopupShown(LXQtTaskGroup* sender);
 
 signals:
@@ -113,11 +120,16 @@ private:
     LXQtTaskButtonHash mButtonHash;
     bool mPreventPopup;
     bool mSingleButton; //!< flag if this group should act as a "standard" button (no groupping or only one "shown" window in group)
+    bool mShownByFilter; //!< flag if any of the windows passes the "show only" filters
+    int mVisibleCount; //!< number of the buttons passing the "show only" filters (maintained incrementally)
+    QString mAppId;
 
     QSize recalculateFrameSize();
     QPoint recalculateFramePosition();
     void recalculateFrameIfVisible();
     void regroup();
+    bool isShownByFilters(LXQtTaskButton * button) const;
+    bool applyVisibility();
 };
 
 #endif // LXQTTASKGROUP_H
@@ -0,0 +1,418 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * LXQt - a lightweight, Qt based, desktop toolset
+ * https://lxqt.org
+ *
+ * Copyright: 2026 LXQt team
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "lxqttaskthumbnailer.h"
+
+#include <QGuiApplication>
+#include <QFutureWatcher>
+#include <QtConcurrent>
+#include <QScopedPointer>
+#include <QX11Info>
+#include <QDebug>
+
+#include <xcb/xcb.h>
+#include <xcb/composite.h>
+#include <xcb/damage.h>
+#include <xcb/shm.h>
+
+#include <sys/ipc.h>
+#include <sys/shm.h>
+
+namespace
+{
+    template<typename T>
+    using ScopedCPointer = QScopedPointer<T, QScopedPointerPodDeleter>;
+
+    //! maximal number of windows grabbed in one capture round
+    constexpr int MAX_CAPTURES_PER_ROUND = 2;
+    //! interval between capture rounds (ms)
+    constexpr int CAPTURE_INTERVAL = 100;
+}
+
+/************************************************
+
+ ************************************************/
+LXQtTaskThumbnailer::LXQtTaskThumbnailer(QObject * parent)
+    : QObject(parent)
+    , mThumbnailSize(160, 100)
+    , mHasComposite(false)
+    , mHasDamage(false)
+    , mHasShm(false)
+    , mDamageEventBase(0)
+    , mShmSegment(0)
+    , mShmId(-1)
+    , mShmAddr(nullptr)
+    , mShmSize(0)
+{
+    if (xcb_connection_t * c = QX11Info::connection())
+    {
+        xcb_prefetch_extension_data(c, &xcb_composite_id);
+        xcb_prefetch_extension_data(c, &xcb_damage_id);
+        xcb_prefetch_extension_data(c, &xcb_shm_id);
+
+        const xcb_query_extension_reply_t * ext = xcb_get_extension_data(c, &xcb_composite_id);
+        if (ext && ext->present)
+        {
+            mHasComposite = true;
+            xcb_composite_query_version_unchecked(c, XCB_COMPOSITE_MAJOR_VERSION, XCB_COMPOSITE_MINOR_VERSION);
+        }
+        ext = xcb_get_extension_data(c, &xcb_damage_id);
+        if (ext && ext->present)
+        {
+            mHasDamage = true;
+            mDamageEventBase = ext->first_event;
+            xcb_damage_query_version_unchecked(c, XCB_DAMAGE_MAJOR_VERSION, XCB_DAMAGE_MINOR_VERSION);
+        }
+        ext = xcb_get_extension_data(c, &xcb_shm_id);
+        mHasShm = ext && ext->present;
+    }
+
+    mCaptureTimer.setInterval(CAPTURE_INTERVAL);
+    connect(&mCaptureTimer, &QTimer::timeout, this, &LXQtTaskThumbnailer::captureRound);
+
+    qApp->installNativeEventFilter(this);
+}
+
+/************************************************
+
+ ************************************************/
+LXQtTaskThumbnailer::~LXQtTaskThumbnailer()
+{
+    qApp->removeNativeEventFilter(this);
+
+    const auto watched = mWatched.keys();
+    for (WId window : watched)
+        unwatch(window);
+    releaseShmSegment();
+}
+
+/************************************************
+
+ ************************************************/
+void LXQtTaskThumbnailer::watch(WId window)
+{
+    xcb_connection_t * c = QX11Info::connection();
+    if (!c || mWatched.contains(window))
+        return;
+
+    // the client window is inside the WM frame, it has no backing pixmap of its own
+    // unless we ask for it (the automatic redirection keeps it painted by the server)
+    if (mHasComposite)
+        xcb_composite_redirect_window(c, window, XCB_COMPOSITE_REDIRECT_AUTOMATIC);
+
+    uint32_t damage = 0;
+    if (mHasDamage)
+    {
+        damage = xcb_generate_id(c);
+        xcb_damage_create(c, damage, window, XCB_DAMAGE_REPORT_LEVEL_NON_EMPTY);
+    }
+    xcb_flush(c);
+
+    mWatched.insert(window, damage);
+    markDirty(window);
+}
+
+/************************************************
+
+ ************************************************/
+void LXQtTaskThumbnailer::unwatch(WId window)
+{
+    auto const i = mWatched.find(window);
+    if (mWatched.end() == i)
+        return;
+
+    if (xcb_connection_t * c = QX11Info::connection())
+    {
+        if (0 != *i)
+            xcb_damage_destroy(c, *i);
+        if (mHasComposite)
+            xcb_composite_unredirect_window(c, window, XCB_COMPOSITE_REDIRECT_AUTOMATIC);
+        xcb_flush(c);
+    }
+
+    mWatched.erase(i);
+    mDirty.removeAll(window);
+    if (mDirty.isEmpty())
+        mCaptureTimer.stop();
+}
+
+/************************************************
+
+ ************************************************/
+void LXQtTaskThumbnailer::forget(WId window)
+{
+    unwatch(window);
+    mThumbnails.remove(window);
+}
+
+/************************************************
+
+ ************************************************/
+bool LXQtTaskThumbnailer::nativeEventFilter(const QByteArray & eventType, void * message, long * /*result*/)
+{
+    if (!mHasDamage || mWatched.isEmpty() || eventType != "xcb_generic_event_t")
+        return false;
+
+    auto * const event = static_cast<xcb_generic_event_t *>(message);
+    if ((event->response_type & ~0x80) != mDamageEventBase + XCB_DAMAGE_NOTIFY)
+        return false;
+
+    auto * const damageEvent = reinterpret_cast<xcb_damage_notify_event_t *>(event);
+    auto const i = mWatched.constFind(damageEvent->drawable);
+    if (mWatched.cend() != i && *i == damageEvent->damage)
+    {
+        // re-arm the damage object, the whole window is captured anyway
+        xcb_damage_subtract(QX11Info::connection(), damageEvent->damage, XCB_NONE, XCB_NONE);
+        markDirty(damageEvent->drawable);
+    }
+    // the event may be interesting for others (e.g. the tray) too
+    return false;
+}
+
+/************************************************
+
+ ************************************************/
+void LXQtTaskThumbnailer::markDirty(WId window)
+{
+    if (!mDirty.contains(window))
+        mDirty.append(window);
+    if (!mCaptureTimer.isActive())
+        mCaptureTimer.start();
+}
+
+/************************************************
+
+ ************************************************/
+void LXQtTaskThumbnailer::captureRound()
+{
+    QList<WId> postponed;
+    for (int captured = 0; captured < MAX_CAPTURES_PER_ROUND && !mDirty.isEmpty(); )
+    {
+        const WId window = mDirty.takeFirst();
+        // previous capture is still being processed, try it in next round
+        if (mScaling.contains(window))
+        {
+            postponed.append(window);
+            continue;
+        }
+
+        ++captured;
+        const QImage image = grab(window);
+        if (image.isNull())
+            continue;
+
+        const qreal ratio = qApp->devicePixelRatio();
+        const QSize size = mThumbnailSize * ratio;
+        mScaling.insert(window);
+        auto * const watcher = new QFutureWatcher<QImage>(this);
+        connect(watcher, &QFutureWatcher<QImage>::finished, this, [this, watcher, window] {
+            mScaling.remove(window);
+            if (mWatched.contains(window))
+            {
+                const QImage thumbnail = watcher->result();
+                mThumbnails[window] = thumbnail;
+                emit thumbnailChanged(window, thumbnail);
+            }
+            watcher->deleteLater();
+        });
+        // Qt's smooth scaling uses the SIMD (SSE4.1/AVX2/NEON) code paths where available
+        watcher->setFuture(QtConcurrent::run([image, size, ratio] {
+            QImage scaled = image.scaled(size, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+            scaled.setDevicePixelRatio(ratio);
+            return scaled;
+        }));
+    }
+    mDirty.append(postponed);
+
+    if (mDirty.isEmpty())
+        mCaptureTimer.stop();
+}
+
+/************************************************
+ Grabs the current contents of the window (a deep copy).
+ ************************************************/
+QImage LXQtTaskThumbnailer::grab(WId window)
+{
+    xcb_connection_t * c = QX11Info::connection();
+    if (!c)
+        return QImage();
+
+    // pipeline the geometry request with the map state one
+    const xcb_get_window_attributes_cookie_t attributesCookie = xcb_get_window_attributes(c, window);
+    const xcb_get_geometry_cookie_t geometryCookie = xcb_get_geometry(c, window);
+    ScopedCPointer<xcb_get_window_attributes_reply_t> attributes(xcb_get_window_attributes_reply(c, attributesCookie, nullptr));
+    ScopedCPointer<xcb_get_geometry_reply_t> geometry(xcb_get_geometry_reply(c, geometryCookie, nullptr));
+    // minimized/unmapped windows have no contents to grab, the cached thumbnail stays
+    if (attributes.isNull() || XCB_MAP_STATE_VIEWABLE != attributes->map_state
+            || geometry.isNull() || 0 == geometry->width || 0 == geometry->height)
+        return QImage();
+
+    // the window can still vanish (or get unmapped) meanwhile, the requests are checked
+    xcb_pixmap_t pixmap = XCB_NONE;
+    xcb_void_cookie_t nameCookie{};
+    if (mHasComposite)
+    {
+        pixmap = xcb_generate_id(c);
+        nameCookie = xcb_composite_name_window_pixmap_checked(c, window, pixmap);
+    }
+
+    const uint16_t width = geometry->width;
+    const uint16_t height = geometry->height;
+    const uint32_t size = width * height * 4;
+    QImage image;
+
+    // the named pixmap is not there (no compositing manager), try the window itself (visible part only)
+    const xcb_drawable_t drawables[] = {pixmap, static_cast<xcb_drawable_t>(window)};
+    for (const xcb_drawable_t drawable : drawables)
+    {
+        if (XCB_NONE == drawable)
+            continue;
+
+        xcb_generic_error_t * error = nullptr;
+        uint8_t depth = 0;
+        const uchar * data = nullptr;
+        ScopedCPointer<xcb_get_image_reply_t> plainReply;
+        if (mHasShm && ensureShmSegment(size))
+        {
+            const auto cookie = xcb_shm_get_image(c, drawable, 0, 0, width, height, ~0u
+                    , XCB_IMAGE_FORMAT_Z_PIXMAP, mShmSegment, 0);
+            ScopedCPointer<xcb_shm_get_image_reply_t> reply(xcb_shm_get_image_reply(c, cookie, &error));
+            if (!reply.isNull() && reply->size >= size)
+            {
+                depth = reply->depth;
+                data = static_cast<const uchar *>(mShmAddr);
+            }
+        } else
+        {
+            const auto cookie = xcb_get_image(c, XCB_IMAGE_FORMAT_Z_PIXMAP, drawable, 0, 0, width, height, ~0u);
+            plainReply.reset(xcb_get_image_reply(c, cookie, &error));
+            if (!plainReply.isNull() && static_cast<uint32_t>(xcb_get_image_data_length(plainReply.data())) >= size)
+            {
+                depth = plainReply->depth;
+                data = xcb_get_image_data(plainReply.data());
+            }
+        }
+
+        // (the failure is expected when the window vanishes, nothing to report)
+        ScopedCPointer<xcb_generic_error_t> imageError(error);
+        if (pixmap == drawable)
+        {
+            // (the reply came after the naming result)
+            ScopedCPointer<xcb_generic_error_t> nameError(xcb_request_check(c, nameCookie));
+            if (!nameError.isNull())
+                pixmap = XCB_NONE;
+        }
+        if (nullptr == data)
+            continue;
+
+        QImage::Format format;
+        switch (depth)
+        {
+        case 32:
+            format = QImage::Format_ARGB32_Premultiplied;
+            break;
+        case 24:
+            format = QImage::Format_RGB32;
+            break;
+        default:
+            qDebug() << "LXQtTaskThumbnailer: unsupported depth" << depth << "of window" << window;
+            continue;
+        }
+        // the data belongs to the X reply/shared segment -> make a deep copy
+        image = QImage(data, width, height, width * 4, format).copy();
+        break;
+    }
+
+    if (XCB_NONE != pixmap)
+        xcb_free_pixmap(c, pixmap);
+    return image;
+}
+
+/************************************************
+ Makes sure there is an attached shared memory segment of (at least) the given size.
+ ************************************************/
+bool LXQtTaskThumbnailer::ensureShmSegment(uint32_t size)
+{
+    if (mShmSize >= size)
+        return true;
+
+    releaseShmSegment();
+
+    xcb_connection_t * c = QX11Info::connection();
+    mShmId = shmget(IPC_PRIVATE, size, IPC_CREAT | 0600);
+    if (mShmId < 0)
+    {
+        qWarning() << "LXQtTaskThumbnailer: unable to create shared memory segment, falling back to plain transfer";
+        mHasShm = false;
+        return false;
+    }
+    mShmAddr = shmat(mShmId, nullptr, 0);
+    if (reinterpret_cast<void *>(-1) == mShmAddr)
+    {
+        shmctl(mShmId, IPC_RMID, nullptr);
+        mShmId = -1;
+        mShmAddr = nullptr;
+        mHasShm = false;
+        return false;
+    }
+
+    mShmSegment = xcb_generate_id(c);
+    ScopedCPointer<xcb_generic_error_t> error(xcb_request_check(c, xcb_shm_attach_checked(c, mShmSegment, mShmId, false)));
+    // the segment is destroyed as soon as both of us detach
+    shmctl(mShmId, IPC_RMID, nullptr);
+    if (!error.isNull())
+    {
+        qWarning() << "LXQtTaskThumbnailer: X server can't attach shared memory segment, falling back to plain transfer";
+        shmdt(mShmAddr);
+        mShmAddr = nullptr;
+        mShmId = -1;
+        mShmSegment = 0;
+        mHasShm = false;
+        return false;
+    }
+
+    mShmSize = size;
+    return true;
+}
+
+/************************************************
+
+ ************************************************/
+void LXQtTaskThumbnailer::releaseShmSegment()
+{
+    if (0 == mShmSize)
+        return;
+
+    if (xcb_connection_t * c = QX11Info::connection())
+    {
+        xcb_shm_detach(c, mShmSegment);
+        xcb_flush(c);
+    }
+    shmdt(mShmAddr);
+    mShmAddr = nullptr;
+    mShmId = -1;
+    mShmSegment = 0;
+    mShmSize = 0;
+}
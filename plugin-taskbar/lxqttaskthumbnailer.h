@@ -0,0 +1,100 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * LXQt - a lightweight, Qt based, desktop toolset
+ * https://lxqt.org
+ *
+ * Copyright: 2026 LXQt team
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#ifndef LXQTTASKTHUMBNAILER_H
+#define LXQTTASKTHUMBNAILER_H
+
+#include <QObject>
+#include <QAbstractNativeEventFilter>
+#include <QHash>
+#include <QSet>
+#include <QList>
+#include <QImage>
+#include <QTimer>
+
+/*! \brief Provider of live window thumbnails for the group popups.
+ *
+ * Only the "watched" windows (the ones which buttons are shown in an open
+ * popup) are captured. Their contents are grabbed through the XComposite
+ * named pixmap (falling back to the window itself without a compositing manager)
+ * into a reusable XShm segment, rescaled in a worker thread and cached.
+ * The X damage extension is used to find out which thumbnails are stale.
+ * At most \c MAX_CAPTURES_PER_ROUND windows are grabbed in one capture round,
+ * so the cost is bounded regardless of the number of windows being repainted.
+ */
+class LXQtTaskThumbnailer : public QObject, public QAbstractNativeEventFilter
+{
+    Q_OBJECT
+
+public:
+    explicit LXQtTaskThumbnailer(QObject * parent = nullptr);
+    ~LXQtTaskThumbnailer();
+
+    //! size (in device independent pixels) the thumbnails fit in
+    QSize thumbnailSize() const { return mThumbnailSize; }
+    //! the last captured (possibly stale) thumbnail of the window
+    QImage thumbnail(WId window) const { return mThumbnails.value(window); }
+
+    //! start keeping the thumbnail of the window up to date
+    void watch(WId window);
+    //! stop updating the thumbnail of the window (the last one stays cached)
+    void unwatch(WId window);
+    //! drop all the data of the window (after it is gone)
+    void forget(WId window);
+
+    bool nativeEventFilter(const QByteArray & eventType, void * message, long * result) override;
+
+signals:
+    void thumbnailChanged(WId window, QImage const & thumbnail);
+
+private slots:
+    void captureRound();
+
+private:
+    void markDirty(WId window);
+    QImage grab(WId window);
+    bool ensureShmSegment(uint32_t size);
+    void releaseShmSegment();
+
+private:
+    QSize mThumbnailSize;
+    QHash<WId, QImage> mThumbnails; //!< cache of scaled thumbnails
+    QHash<WId, uint32_t> mWatched; //!< watched windows (mapping to damage objects)
+    QList<WId> mDirty; //!< watched windows waiting for capture (in order of damage)
+    QSet<WId> mScaling; //!< windows which thumbnail is being scaled in worker thread
+    QTimer mCaptureTimer;
+
+    bool mHasComposite;
+    bool mHasDamage;
+    bool mHasShm;
+    uint8_t mDamageEventBase;
+
+    uint32_t mShmSegment; //!< X id of the shared memory segment
+    int mShmId;
+    void * mShmAddr;
+    uint32_t mShmSize;
+};
+
+#endif // LXQTTASKTHUMBNAILER_H
@@ -37,10 +37,12 @@
 
 #include <xcb/composite.h>
 #include <xcb/damage.h>
+#include <xcb/xfixes.h>
 #include <xcb/xcb_atom.h>
 #include <xcb/xcb_event.h>
 
 #include "sniproxy.h"
+#include "traystats.h"
 #include "xcbutils.h"
 
 #define SYSTEM_TRAY_REQUEST_DOCK 0
@@ -50,9 +52,18 @@
 FdoSelectionManager::FdoSelectionManager()
     : m_atoms{new Xcb::Atoms}
     , m_selectionOwner{new KSelectionOwner{m_atoms->selectionAtom, -1, this}}
+    , m_captureInterval{0}
 {
     qDebug() << "starting";
 
+    // the damage is collected and all the damaged icons are captured at once
+    m_captureTimer.setSingleShot(true);
+    connect(&m_captureTimer, &QTimer::timeout, this, &FdoSelectionManager::captureDirty);
+    // the dock requests are processed in a batch per event loop turn
+    m_dockTimer.setSingleShot(true);
+    m_dockTimer.setInterval(0);
+    connect(&m_dockTimer, &QTimer::timeout, this, &FdoSelectionManager::dockPending);
+
     // we may end up calling QCoreApplication::quit() in this method, at which point we need the event loop running
     QTimer::singleShot(0, this, &FdoSelectionManager::init);
 }
@@ -64,6 +75,9 @@ FdoSelectionManager::~FdoSelectionManager()
         undock(p_i.key(), false);
     }
     m_selectionOwner->release();
+    if (XCB_NONE != m_damageRegion) {
+        xcb_xfixes_destroy_region(QX11Info::connection(), m_damageRegion);
+    }
 }
 
 void FdoSelectionManager::init()
@@ -85,6 +99,15 @@ void FdoSelectionManager::init()
         return;
     }
 
+    // the damaged region is fetched through XFixes (for capturing just the damaged part)
+    xcb_prefetch_extension_data(c, &xcb_xfixes_id);
+    const auto *xfixes = xcb_get_extension_data(c, &xcb_xfixes_id);
+    if (xfixes && xfixes->present) {
+        xcb_xfixes_query_version_unchecked(c, XCB_XFIXES_MAJOR_VERSION, XCB_XFIXES_MINOR_VERSION);
+        m_damageRegion = xcb_generate_id(c);
+        xcb_xfixes_create_region(c, m_damageRegion, 0, nullptr);
+    }
+
     qApp->installNativeEventFilter(this);
 
     connect(m_selectionOwner, &KSelectionOwner::claimedOwnership, this, &FdoSelectionManager::onClaimedOwnership);
@@ -93,38 +116,57 @@ void FdoSelectionManager::init()
     m_selectionOwner->claim(false);
 }
 
-bool FdoSelectionManager::addDamageWatch(xcb_window_t client)
+QVector<xcb_window_t> FdoSelectionManager::addDamageWatches(const QVector<xcb_window_t> &clients)
 {
-    qDebug() << "adding damage watch for " << client;
+    qDebug() << "adding damage watch for " << clients;
 
     xcb_connection_t *c = QX11Info::connection();
-    const auto attribsCookie = xcb_get_window_attributes_unchecked(c, client);
-
-    const auto damageId = xcb_generate_id(c);
-    m_damageWatches[client] = damageId;
-    xcb_damage_create(c, damageId, client, XCB_DAMAGE_REPORT_LEVEL_NON_EMPTY);
-
-    xcb_generic_error_t *error = nullptr;
-    QScopedPointer<xcb_get_window_attributes_reply_t, QScopedPointerPodDeleter> attr(xcb_get_window_attributes_reply(c, attribsCookie, &error));
-    QScopedPointer<xcb_generic_error_t, QScopedPointerPodDeleter> getAttrError(error);
-    uint32_t events = XCB_EVENT_MASK_STRUCTURE_NOTIFY;
-    if (!attr.isNull()) {
-        events = events | attr->your_event_mask;
+
+    // all the requests are issued first, the replies are collected afterwards (in one round trip)
+    QVector<xcb_get_window_attributes_cookie_t> attribsCookies;
+    attribsCookies.reserve(clients.count());
+    for (const auto client : clients) {
+        attribsCookies << xcb_get_window_attributes_unchecked(c, client);
+
+        const auto damageId = xcb_generate_id(c);
+        m_damageWatches[client] = damageId;
+        xcb_damage_create(c, damageId, client, XCB_DAMAGE_REPORT_LEVEL_NON_EMPTY);
     }
-    // if window is already gone, there is no need to handle it.
-    if (getAttrError && getAttrError->error_code == XCB_WINDOW) {
-        return false;
+
+    QVector<xcb_window_t> alive;
+    QVector<xcb_void_cookie_t> changeAttrCookies;
+    for (int i = 0; i < clients.count(); ++i) {
+        const auto client = clients.at(i);
+        xcb_generic_error_t *error = nullptr;
+        QScopedPointer<xcb_get_window_attributes_reply_t, QScopedPointerPodDeleter> attr(xcb_get_window_attributes_reply(c, attribsCookies.at(i), &error));
+        QScopedPointer<xcb_generic_error_t, QScopedPointerPodDeleter> getAttrError(error);
+        // if window is already gone, there is no need to handle it.
+        if (getAttrError && getAttrError->error_code == XCB_WINDOW) {
+            m_damageWatches.remove(client);
+            continue;
+        }
+        uint32_t events = XCB_EVENT_MASK_STRUCTURE_NOTIFY;
+        if (!attr.isNull()) {
+            events = events | attr->your_event_mask;
+        }
+        // the event mask will not be removed again. We cannot track whether another component also needs STRUCTURE_NOTIFY (e.g. KWindowSystem).
+        // if we would remove the event mask again, other areas will break.
+        changeAttrCookies << xcb_change_window_attributes_checked(c, client, XCB_CW_EVENT_MASK, &events);
+        alive << client;
     }
-    // the event mask will not be removed again. We cannot track whether another component also needs STRUCTURE_NOTIFY (e.g. KWindowSystem).
-    // if we would remove the event mask again, other areas will break.
-    const auto changeAttrCookie = xcb_change_window_attributes_checked(c, client, XCB_CW_EVENT_MASK, &events);
-    QScopedPointer<xcb_generic_error_t, QScopedPointerPodDeleter> changeAttrError(xcb_request_check(c, changeAttrCookie));
-    // if window is gone by this point, it will be caught by eventFilter, so no need to check later errors.
-    if (changeAttrError && changeAttrError->error_code == XCB_WINDOW) {
-        return false;
+
+    QVector<xcb_window_t> watched;
+    for (int i = 0; i < alive.count(); ++i) {
+        QScopedPointer<xcb_generic_error_t, QScopedPointerPodDeleter> changeAttrError(xcb_request_check(c, changeAttrCookies.at(i)));
+        // if window is gone by this point, it will be caught by eventFilter, so no need to check later errors.
+        if (changeAttrError && changeAttrError->error_code == XCB_WINDOW) {
+            m_damageWatches.remove(alive.at(i));
+            continue;
+        }
+        watched << alive.at(i);
     }
 
-    return true;
+    return watched;
 }
 
 bool FdoSelectionManager::nativeEventFilter(const QByteArray &eventType, void *message, long int *result)
@@ -154,15 +196,32 @@ bool FdoSelectionManager::nativeEventFilter(const QByteArray &eventType, void *m
         }
     } else if (responseType == XCB_DESTROY_NOTIFY) {
         const auto destroyedWId = reinterpret_cast<xcb_destroy_notify_event_t *>(ev)->window;
+        m_pendingDocks.removeOne(destroyedWId);
         if (m_proxies.contains(destroyedWId)) {
             undock(destroyedWId, true);
         }
     } else if (responseType == m_damageEventBase + XCB_DAMAGE_NOTIFY) {
         const auto damagedWId = reinterpret_cast<xcb_damage_notify_event_t *>(ev)->drawable;
-        const auto sniProxy = m_proxies.value(damagedWId);
-        if (sniProxy) {
-            sniProxy->update();
-            xcb_damage_subtract(QX11Info::connection(), m_damageWatches[damagedWId], XCB_NONE, XCB_NONE);
+        if (m_proxies.contains(damagedWId)) {
+            // subtract right away to get notified about the next damage
+            if (XCB_NONE != m_damageRegion) {
+                // the damage is collected on the server, fetched just once by the capture
+                xcb_connection_t *c = QX11Info::connection();
+                auto &collected = m_damagedRegions[damagedWId];
+                if (XCB_NONE == collected) {
+                    collected = xcb_generate_id(c);
+                    xcb_xfixes_create_region(c, collected, 0, nullptr);
+                }
+                xcb_damage_subtract(c, m_damageWatches[damagedWId], XCB_NONE, m_damageRegion);
+                xcb_xfixes_union_region(c, collected, m_damageRegion, collected);
+            } else {
+                xcb_damage_subtract(QX11Info::connection(), m_damageWatches[damagedWId], XCB_NONE, XCB_NONE);
+            }
+            m_dirty.insert(damagedWId);
+            if (const auto stats = TrayStats::instance()) {
+                stats->damaged(damagedWId);
+            }
+            scheduleCapture();
         }
     } else if (responseType == XCB_CONFIGURE_REQUEST) {
         const auto event = reinterpret_cast<xcb_configure_request_event_t *>(ev);
@@ -171,6 +230,7 @@ bool FdoSelectionManager::nativeEventFilter(const QByteArray &eventType, void *m
             // The embedded window tries to move or resize. Ignore move, handle resize only.
             if ((event->value_mask & XCB_CONFIG_WINDOW_WIDTH) || (event->value_mask & XCB_CONFIG_WINDOW_HEIGHT)) {
                 sniProxy->resizeWindow(event->width, event->height);
+                xcb_flush(QX11Info::connection());
             }
         }
     } else if (responseType == XCB_VISIBILITY_NOTIFY) {
@@ -191,13 +251,51 @@ void FdoSelectionManager::dock(xcb_window_t winId)
 {
     qDebug() << "trying to dock window " << winId;
 
-    if (m_proxies.contains(winId)) {
+    if (m_proxies.contains(winId) || m_pendingDocks.contains(winId)) {
+        return;
+    }
+
+    // the clients tend to come all at once (at the session start), dock them together
+    m_pendingDocks << winId;
+    if (!m_dockTimer.isActive()) {
+        m_dockTimer.start();
+    }
+}
+
+void FdoSelectionManager::dockPending()
+{
+    const auto windows = addDamageWatches(m_pendingDocks);
+    m_pendingDocks.clear();
+    if (windows.isEmpty()) {
         return;
     }
 
-    if (addDamageWatch(winId)) {
-        m_proxies[winId] = new SNIProxy(winId, *m_atoms, this);
+    const bool sharedDBus = SNIProxy::watcherTracksPaths();
+    QVector<SNIProxy *> proxies;
+    proxies.reserve(windows.count());
+    for (const auto winId : windows) {
+        proxies << new SNIProxy(winId, *m_atoms, sharedDBus, this);
+        m_proxies[winId] = proxies.last();
+        if (const auto stats = TrayStats::instance()) {
+            stats->docked();
+        }
+    }
+    for (const auto proxy : proxies) {
+        proxy->finishInit();
     }
+    xcb_flush(QX11Info::connection());
+
+    // there's no damage event for the first paint, and sometimes it's not drawn immediately
+    // not ideal, but it works better than nothing
+    // test with xchat before changing
+    QTimer::singleShot(500, this, [this, windows] {
+        for (const auto winId : windows) {
+            if (m_proxies.contains(winId)) {
+                m_dirty.insert(winId);
+            }
+        }
+        scheduleCapture();
+    });
 }
 
 void FdoSelectionManager::undock(xcb_window_t winId, bool vanished)
@@ -208,6 +306,11 @@ void FdoSelectionManager::undock(xcb_window_t winId, bool vanished)
     if (p_i == m_proxies.end()) {
         return;
     }
+    m_dirty.remove(winId);
+    const auto collected = m_damagedRegions.take(winId);
+    if (XCB_NONE != collected) {
+        xcb_xfixes_destroy_region(QX11Info::connection(), collected);
+    }
     auto d_i = m_damageWatches.find(winId);
     if (d_i != m_damageWatches.end()) {
         if (!vanished) {
@@ -215,11 +318,81 @@ void FdoSelectionManager::undock(xcb_window_t winId, bool vanished)
         }
         m_damageWatches.erase(d_i);
     }
+    if (const auto stats = TrayStats::instance()) {
+        stats->undocked(winId);
+    }
     (*p_i)->vanished(vanished);
     (*p_i)->deleteLater();
     m_proxies.erase(p_i);
 }
 
+void FdoSelectionManager::setMaxCaptureRate(int capturesPerSecond)
+{
+    m_captureInterval = 0 < capturesPerSecond ? 1000 / capturesPerSecond : 0;
+}
+
+void FdoSelectionManager::scheduleCapture()
+{
+    if (m_captureTimer.isActive()) {
+        return;
+    }
+    int delay = 0;
+    if (m_lastCapture.isValid()) {
+        delay = qMax(0, m_captureInterval - static_cast<int>(m_lastCapture.elapsed()));
+    }
+    m_captureTimer.start(delay);
+}
+
+void FdoSelectionManager::captureDirty()
+{
+    const auto dirty = m_dirty;
+    m_dirty.clear();
+
+    // the collected damage of all the windows is fetched at once (a single round trip)
+    xcb_connection_t *c = QX11Info::connection();
+    QHash<xcb_window_t, xcb_xfixes_fetch_region_cookie_t> fetches;
+    for (const auto winId : dirty) {
+        const auto collected = m_damagedRegions.value(winId, XCB_NONE);
+        if (XCB_NONE != collected) {
+            fetches[winId] = xcb_xfixes_fetch_region(c, collected);
+            // emptied for the next capture (the requests are ordered)
+            xcb_xfixes_set_region(c, collected, 0, nullptr);
+        }
+    }
+
+    const auto stats = TrayStats::instance();
+    for (const auto winId : dirty) {
+        if (const auto sniProxy = m_proxies.value(winId)) {
+            QElapsedTimer duration;
+            duration.start();
+            sniProxy->update(damagedRect(fetches, winId));
+            if (stats) {
+                stats->captured(winId, duration.nsecsElapsed());
+            }
+        }
+    }
+    // (the windows undocked in the meantime)
+    for (const auto &cookie : qAsConst(fetches)) {
+        xcb_discard_reply(c, cookie.sequence);
+    }
+    m_lastCapture.start();
+}
+
+QRect FdoSelectionManager::damagedRect(QHash<xcb_window_t, xcb_xfixes_fetch_region_cookie_t> &fetches, xcb_window_t winId)
+{
+    const auto f_i = fetches.find(winId);
+    if (f_i == fetches.end()) {
+        // unknown -> the whole window
+        return QRect{};
+    }
+    QScopedPointer<xcb_xfixes_fetch_region_reply_t, QScopedPointerPodDeleter> region(xcb_xfixes_fetch_region_reply(QX11Info::connection(), *f_i, nullptr));
+    fetches.erase(f_i);
+    if (!region) {
+        return QRect{};
+    }
+    return QRect{region->extents.x, region->extents.y, region->extents.width, region->extents.height};
+}
+
 void FdoSelectionManager::onClaimedOwnership()
 {
     qDebug() << "Manager selection claimed";
@@ -27,10 +27,17 @@
 #pragma once
 
 #include <QAbstractNativeEventFilter>
+#include <QElapsedTimer>
 #include <QHash>
 #include <QObject>
+#include <QSet>
+#include <QTimer>
+#include <QVector>
+
+#include <QRect>
 
 #include <xcb/xcb.h>
+#include <xcb/xfixes.h>
 #include <memory>
 
 class KSelectionOwner;
@@ -48,6 +55,12 @@ public:
     FdoSelectionManager();
     ~FdoSelectionManager() override;
 
+    /**
+     * Sets the maximal number of icon captures per second (for each icon),
+     * 0 means no limit
+     */
+    void setMaxCaptureRate(int capturesPerSecond);
+
 protected:
     bool nativeEventFilter(const QByteArray &eventType, void *message, long *result) override;
 
@@ -55,18 +68,38 @@ private Q_SLOTS:
     void onClaimedOwnership();
     void onFailedToClaimOwnership();
     void onLostOwnership();
+    void captureDirty();
+    void dockPending();
 
 private:
     void init();
-    bool addDamageWatch(xcb_window_t client);
+    /**
+     * @return the clients being watched (the others are gone already)
+     */
+    QVector<xcb_window_t> addDamageWatches(const QVector<xcb_window_t> &clients);
     void dock(xcb_window_t embed_win);
     void undock(xcb_window_t client, bool vanished);
     void setSystemTrayVisual();
+    void scheduleCapture();
+    /**
+     * Collects the reply of the window's fetch (if any) from the \p fetches.
+     * @return the bounding rectangle of the window damage since the last capture
+     * (null if it isn't known)
+     */
+    QRect damagedRect(QHash<xcb_window_t, xcb_xfixes_fetch_region_cookie_t> &fetches, xcb_window_t winId);
 
     uint8_t m_damageEventBase;
 
     QHash<xcb_window_t, u_int32_t> m_damageWatches;
     QHash<xcb_window_t, SNIProxy *> m_proxies;
+    QVector<xcb_window_t> m_pendingDocks; //!< dock requests waiting for the batch
+    QTimer m_dockTimer;
+    QSet<xcb_window_t> m_dirty; //!< damaged windows waiting for the capture
+    xcb_xfixes_region_t m_damageRegion = XCB_NONE; //!< the repaired part of the damage is stored here
+    QHash<xcb_window_t, xcb_xfixes_region_t> m_damagedRegions; //!< the damage collected since the last capture
+    QTimer m_captureTimer;
+    QElapsedTimer m_lastCapture;
+    int m_captureInterval; //!< minimal interval between the captures (ms)
     std::unique_ptr<Xcb::Atoms> m_atoms;
     KSelectionOwner *m_selectionOwner;
 };
@@ -28,18 +28,26 @@
 
 #include "lxqttrayplugin.h"
 #include "fdoselectionmanager.h"
+#include "../panel/pluginsettings.h"
 
 LXQtTrayPlugin::LXQtTrayPlugin(const ILXQtPanelPluginStartupInfo &startupInfo)
     : QObject()
     , ILXQtPanelPlugin(startupInfo)
     , mManager{new FdoSelectionManager}
 {
+    settingsChanged();
 }
 
 LXQtTrayPlugin::~LXQtTrayPlugin()
 {
 }
 
+void LXQtTrayPlugin::settingsChanged()
+{
+    // animated icons are captured at most this many times per second
+    mManager->setMaxCaptureRate(settings()->value(QStringLiteral("maxIconFps"), 10).toInt());
+}
+
 QWidget *LXQtTrayPlugin::widget()
 {
     return nullptr;
@@ -47,6 +47,8 @@ public:
 
     bool isSeparate() const { return true; }
 
+    virtual void settingsChanged();
+
 private:
     std::unique_ptr<FdoSelectionManager> mManager;
 
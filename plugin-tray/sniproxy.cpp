@@ -30,10 +30,19 @@
 #include <algorithm>
 #include <xcb/xcb_atom.h>
 #include <xcb/xcb_event.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #include "xcbutils.h"
 
+#include <QDBusMessage>
+#include <QDBusPendingCallWatcher>
+#include <QDBusReply>
 #include <QDebug>
+#include <QHash>
 #include <QGuiApplication>
 #include <QScreen>
 #include <QTimer>
@@ -47,6 +56,7 @@
 #include "statusnotifieritemadaptor.h"
 #include "statusnotifierwatcher_interface.h"
 
+#include "traystats.h"
 #include "xtestsender.h"
 
 //#define VISUAL_DEBUG
@@ -56,9 +66,23 @@
 
 static uint16_t s_embedSize = 128; // size of window to embed
 static unsigned int XEMBED_VERSION = 0;
+static bool s_shmUsable = true; // turned off on first SHM failure
 
 int SNIProxy::s_serviceCount = 0;
 
+// The StatusNotifierItem spec has no way to unregister an item other than
+// the service vanishing. Our watcher understands the (non-standard)
+// UnregisterStatusNotifierItem, so all the items can share one connection.
+bool SNIProxy::watcherTracksPaths()
+{
+    QDBusMessage introspect = QDBusMessage::createMethodCall(QStringLiteral(SNI_WATCHER_SERVICE_NAME),
+                                                             QStringLiteral(SNI_WATCHER_PATH),
+                                                             QStringLiteral("org.freedesktop.DBus.Introspectable"),
+                                                             QStringLiteral("Introspect"));
+    QDBusReply<QString> reply = QDBusConnection::sessionBus().call(introspect);
+    return reply.isValid() && reply.value().contains(QLatin1String("\"UnregisterStatusNotifierItem\""));
+}
+
 void xembed_message_send(Xcb::Atoms & atoms, xcb_window_t towin, long message, long d1, long d2, long d3)
 {
     xcb_client_message_event_t ev;
@@ -75,52 +99,143 @@ void xembed_message_send(Xcb::Atoms & atoms, xcb_window_t towin, long message, l
     xcb_send_event(QX11Info::connection(), false, towin, XCB_EVENT_MASK_NO_EVENT, (char *)&ev);
 }
 
-static QRect findOpaqueArea(const QImage & image, int margin = 0)
+static const quint32 s_alphaMask = 0xff000000;
+
+// index of the first pixel with non-zero alpha in [from, to), to if there is none
+static int firstOpaque(const quint32 *line, int from, int to)
+{
+    int x = from;
+#ifdef __SSE2__
+    const __m128i alphaMask = _mm_set1_epi32(static_cast<int>(s_alphaMask));
+    const __m128i zero = _mm_setzero_si128();
+    for (; x + 4 <= to; x += 4) {
+        const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(line + x));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(pixels, alphaMask), zero)) != 0xffff) {
+            break; // the scalar loop finds the exact one
+        }
+    }
+#endif
+    for (; x < to; ++x) {
+        if (line[x] & s_alphaMask) {
+            return x;
+        }
+    }
+    return to;
+}
+
+// index of the last pixel with non-zero alpha in [from, to), from - 1 if there is none
+static int lastOpaque(const quint32 *line, int from, int to)
+{
+    int x = to;
+#ifdef __SSE2__
+    const __m128i alphaMask = _mm_set1_epi32(static_cast<int>(s_alphaMask));
+    const __m128i zero = _mm_setzero_si128();
+    for (; x - 4 >= from; x -= 4) {
+        const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(line + x - 4));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(pixels, alphaMask), zero)) != 0xffff) {
+            break;
+        }
+    }
+#endif
+    for (; x > from; --x) {
+        if (line[x - 1] & s_alphaMask) {
+            return x - 1;
+        }
+    }
+    return from - 1;
+}
+
+/*
+  Bounding box of the pixels with non-zero alpha (empty for a fully transparent image).
+  The image is scanned row by row in a single pass; once a row extends the box,
+  the following rows only need to be checked outside of it.
+*/
+static QRect findOpaqueArea(const QImage &image)
 {
-    int w = image.width();
-    int h = image.height();
-    int left = image.width(), right = 0, top = image.height(), bottom = 0;
-    for (int x = 0; x < w; ++x) {
-        for (int y = 0; y < h; ++y) {
-            if (qAlpha(image.pixel(x, y))) {
-                // Found an opaque pixel.
-                if (x < left) left = x;
-                if (x > right) right = x;
-                if (y < top) top = y;
-                if (y > bottom) bottom = y;
+    if (image.isNull()) {
+        return QRect{};
+    }
+    if (!image.hasAlphaChannel()) {
+        return image.rect();
+    }
+    if (image.format() != QImage::Format_ARGB32 && image.format() != QImage::Format_ARGB32_Premultiplied) {
+        return findOpaqueArea(image.convertToFormat(QImage::Format_ARGB32));
+    }
+
+    const int w = image.width();
+    const int h = image.height();
+    int left = w, right = -1, top = -1, bottom = -1;
+    for (int y = 0; y < h; ++y) {
+        const quint32 *line = reinterpret_cast<const quint32 *>(image.constScanLine(y));
+        bool opaque = false;
+        if (top < 0) {
+            // no opaque pixel yet -> the whole row
+            left = firstOpaque(line, 0, w);
+            if (left < w) {
+                right = lastOpaque(line, left, w);
+                opaque = true;
+            }
+        } else {
+            // only the parts outside of the current box
+            const int l = firstOpaque(line, 0, left);
+            if (l < left) {
+                left = l;
+                opaque = true;
             }
+            const int r = lastOpaque(line, right + 1, w);
+            if (r > right) {
+                right = r;
+                opaque = true;
+            }
+            // a row inside the box counts for the bottom edge too
+            opaque = opaque || firstOpaque(line, left, right + 1) <= right;
+        }
+        if (opaque) {
+            if (top < 0) {
+                top = y;
+            }
+            bottom = y;
         }
     }
 
-    QRect r{QPoint{left - margin, top - margin}, QPoint{right + margin, bottom + margin}};
-    return r;
+    if (top < 0) {
+        return QRect{};
+    }
+    return QRect{QPoint{left, top}, QPoint{right, bottom}};
 }
 
-SNIProxy::SNIProxy(xcb_window_t wid, Xcb::Atoms & atoms, QObject *parent)
+SNIProxy::SNIProxy(xcb_window_t wid, Xcb::Atoms & atoms, bool sharedDBus, QObject *parent)
     : QObject(parent)
+    , m_sharedDBus(sharedDBus)
     ,
-    // Work round a bug in our SNIWatcher with multiple SNIs per connection.
-    // there is an undocumented feature that you can register an SNI by path, however it doesn't detect an object on a service being removed, only the entire
-    // service closing instead lets use one DBus connection per SNI
-    m_dbus(QDBusConnection::connectToBus(QDBusConnection::SessionBus, QStringLiteral("XembedSniProxy%1").arg(s_serviceCount++)))
+    // There is an undocumented feature that you can register an SNI by path (the service is the sender),
+    // but watchers detect only the entire service closing, not an object on it being removed.
+    // Unless the watcher can be told about the removal, use one DBus connection per SNI.
+    m_dbus(m_sharedDBus ? QDBusConnection::connectToBus(QDBusConnection::SessionBus, QStringLiteral("XembedSniProxy"))
+                        : QDBusConnection::connectToBus(QDBusConnection::SessionBus, QStringLiteral("XembedSniProxy%1").arg(s_serviceCount++)))
+    , m_dbusPath(m_sharedDBus ? QStringLiteral("/StatusNotifierItem/%1").arg(wid) : QStringLiteral("/StatusNotifierItem"))
     , m_windowId(wid)
     , sendingClickEvent(false)
     , m_injectMode(Direct)
     , m_atoms{atoms}
+    , m_shm{0, -1, nullptr}
 {
     resizeWindow(s_embedSize, s_embedSize);
 
     // create new SNI
     new StatusNotifierItemAdaptor(this);
-    m_dbus.registerObject(QStringLiteral("/StatusNotifierItem"), this);
-
-    auto statusNotifierWatcher =
-        new org::kde::StatusNotifierWatcher(QStringLiteral(SNI_WATCHER_SERVICE_NAME), QStringLiteral(SNI_WATCHER_PATH), QDBusConnection::sessionBus(), this);
-    auto reply = statusNotifierWatcher->RegisterStatusNotifierItem(m_dbus.baseService());
-    reply.waitForFinished();
-    if (reply.isError()) {
-        qWarning() << "could not register SNI:" << reply.error().message();
-    }
+    m_dbus.registerObject(m_dbusPath, this);
+
+    // the path registration must come from the item's connection (the watcher takes the service from the sender),
+    // don't block on it - the watcher may live in this very process
+    m_statusNotifierWatcher = new org::kde::StatusNotifierWatcher(QStringLiteral(SNI_WATCHER_SERVICE_NAME), QStringLiteral(SNI_WATCHER_PATH), m_dbus, this);
+    auto registration = new QDBusPendingCallWatcher(m_statusNotifierWatcher->RegisterStatusNotifierItem(m_sharedDBus ? m_dbusPath : m_dbus.baseService()), this);
+    connect(registration, &QDBusPendingCallWatcher::finished, this, [](QDBusPendingCallWatcher *call) {
+        if (call->isError()) {
+            qWarning() << "could not register SNI:" << call->error().message();
+        }
+        call->deleteLater();
+    });
 
     auto c = QX11Info::connection();
 
@@ -167,8 +282,6 @@ SNIProxy::SNIProxy(xcb_window_t wid, Xcb::Atoms & atoms, QObject *parent)
     wm.setOpacity(0);
 #endif
 
-    xcb_flush(c);
-
     xcb_map_window(c, m_containerWid);
 
     xcb_reparent_window(c, m_windowId, m_containerWid, 0, 0);
@@ -191,15 +304,11 @@ SNIProxy::SNIProxy(xcb_window_t wid, Xcb::Atoms & atoms, QObject *parent)
 
     xcb_configure_window(c, m_windowId, XCB_CONFIG_WINDOW_X | XCB_CONFIG_WINDOW_Y, windowMoveConfigVals);
 
-    QSize clientWindowSize = calculateClientWindowSize();
+    m_geometryCookie = xcb_get_geometry(c, m_windowId);
 
     // show the embedded window otherwise nothing happens
     xcb_map_window(c, m_windowId);
 
-    xcb_clear_area(c, 0, m_windowId, 0, 0, clientWindowSize.width(), clientWindowSize.height());
-
-    xcb_flush(c);
-
     // guess which input injection method to use
     // we can either send an X event to the client or XTest
     // some don't support direct X events (GTK3/4), and some don't support XTest because reasons
@@ -207,16 +316,22 @@ SNIProxy::SNIProxy(xcb_window_t wid, Xcb::Atoms & atoms, QObject *parent)
 
     // we query if the client selected button presses in the event mask
     // if the client does supports that we send directly, otherwise we'll use xtest
-    auto waCookie = xcb_get_window_attributes(c, m_windowId);
-    QScopedPointer<xcb_get_window_attributes_reply_t, QScopedPointerPodDeleter> windowAttributes(xcb_get_window_attributes_reply(c, waCookie, nullptr));
+    m_attributesCookie = xcb_get_window_attributes(c, m_windowId);
+}
+
+void SNIProxy::finishInit()
+{
+    auto c = QX11Info::connection();
+
+    QScopedPointer<xcb_get_geometry_reply_t, QScopedPointerPodDeleter> clientGeom(xcb_get_geometry_reply(c, m_geometryCookie, nullptr));
+    QSize clientWindowSize = clientWindowSizeOf(clientGeom.get());
+
+    xcb_clear_area(c, 0, m_windowId, 0, 0, clientWindowSize.width(), clientWindowSize.height());
+
+    QScopedPointer<xcb_get_window_attributes_reply_t, QScopedPointerPodDeleter> windowAttributes(xcb_get_window_attributes_reply(c, m_attributesCookie, nullptr));
     if (windowAttributes && !(windowAttributes->all_event_masks & XCB_EVENT_MASK_BUTTON_PRESS)) {
         m_injectMode = XTest;
     }
-
-    // there's no damage event for the first paint, and sometimes it's not drawn immediately
-    // not ideal, but it works better than nothing
-    // test with xchat before changing
-    QTimer::singleShot(500, this, &SNIProxy::update);
 }
 
 SNIProxy::~SNIProxy()
@@ -227,19 +342,51 @@ SNIProxy::~SNIProxy()
         xcb_reparent_window(c, m_windowId, QX11Info::appRootWindow(), 0, 0);
     }
     xcb_destroy_window(c, m_containerWid);
-    QDBusConnection::disconnectFromBus(m_dbus.name());
+    releaseShmSegment();
+    if (m_sharedDBus) {
+        m_dbus.unregisterObject(m_dbusPath);
+        m_statusNotifierWatcher->UnregisterStatusNotifierItem(m_dbusPath);
+    } else {
+        QDBusConnection::disconnectFromBus(m_dbus.name());
+    }
 }
 
-void SNIProxy::update()
+void SNIProxy::update(const QRect &damaged)
 {
-    m_windowImage = getImageNonComposite();
+    QRect opaqueArea;
+    if (!captureDamaged(damaged, opaqueArea)) {
+        m_windowResized = false;
+        m_windowImage = getImageNonComposite(opaqueArea);
+    }
+    m_opaqueArea = opaqueArea;
     if (m_windowImage.isNull()) {
         m_iconImage = QImage{};
+        m_iconHash = 0;
+        m_iconPixmaps.clear();
+        m_iconPixmapsValid = false;
+        if (const auto stats = TrayStats::instance()) {
+            stats->captureFailed();
+        }
         qDebug() << "No xembed icon for" << m_windowId << Title();
         return;
     }
-    m_iconImage = m_windowImage.copy(findOpaqueArea(m_windowImage, 1));
+    m_iconImage = m_windowImage.copy(opaqueArea.adjusted(-1, -1, 1, 1));
     //qDebug() << Title() << "windowImage.size:" << m_windowImage.size() << ", iconImage.size:" << m_iconImage.size();
+
+    // the damage doesn't necessarily mean the pixels changed (e.g. repaint of the same frame)
+    const uint hash = qHashBits(m_iconImage.constBits(), m_iconImage.sizeInBytes(), qHash(m_iconImage.width()) ^ m_iconImage.height());
+    if (hash == m_iconHash) {
+        if (const auto stats = TrayStats::instance()) {
+            stats->iconUnchanged();
+        }
+        return;
+    }
+    m_iconHash = hash;
+    m_iconPixmaps.clear();
+    m_iconPixmapsValid = false;
+    if (const auto stats = TrayStats::instance()) {
+        stats->iconAnnounced();
+    }
     Q_EMIT NewIcon();
     Q_EMIT NewToolTip();
 }
@@ -250,8 +397,8 @@ void SNIProxy::resizeWindow(const uint16_t width, const uint16_t height) const
 
     const uint32_t windowSizeConfigVals[2] = {width, height};
     xcb_configure_window(connection, m_windowId, XCB_CONFIG_WINDOW_WIDTH | XCB_CONFIG_WINDOW_HEIGHT, windowSizeConfigVals);
-
-    xcb_flush(connection);
+    // the pixels out of the new size mustn't stay in the image
+    m_windowResized = true;
 }
 
 void SNIProxy::hideContainerWindow(xcb_window_t windowId) const
@@ -262,16 +409,24 @@ void SNIProxy::hideContainerWindow(xcb_window_t windowId) const
     }
 }
 
-QSize SNIProxy::calculateClientWindowSize() const
+QSize SNIProxy::calculateClientWindowSize(uint8_t *depth) const
 {
     auto c = QX11Info::connection();
 
     auto cookie = xcb_get_geometry(c, m_windowId);
     QScopedPointer<xcb_get_geometry_reply_t, QScopedPointerPodDeleter> clientGeom(xcb_get_geometry_reply(c, cookie, nullptr));
 
+    return clientWindowSizeOf(clientGeom.get(), depth);
+}
+
+QSize SNIProxy::clientWindowSizeOf(xcb_get_geometry_reply_t *clientGeom, uint8_t *depth) const
+{
     QSize clientWindowSize;
     if (clientGeom) {
         clientWindowSize = QSize(clientGeom->width, clientGeom->height);
+        if (depth) {
+            *depth = clientGeom->depth;
+        }
     }
     // if the window is a clearly stupid size resize to be something sensible
     // this is needed as chromium and such when resized just fill the icon with transparent space and only draw in the middle
@@ -293,36 +448,20 @@ void sni_cleanup_xcb_image(void *data)
     xcb_image_destroy(static_cast<xcb_image_t *>(data));
 }
 
-bool SNIProxy::isTransparentImage(const QImage &image) const
+QImage SNIProxy::getImageNonComposite(QRect &opaqueArea)
 {
-    int w = image.width();
-    int h = image.height();
+    auto c = QX11Info::connection();
 
-    // check for the center and sub-center pixels first and avoid full image scan
-    if (!(qAlpha(image.pixel(w >> 1, h >> 1)) + qAlpha(image.pixel(w >> 2, h >> 2)) == 0))
-        return false;
+    uint8_t depth = 0;
+    QSize clientWindowSize = calculateClientWindowSize(&depth);
 
-    // skip scan altogether if sub-center pixel found to be opaque
-    // and break out from the outer loop too on full scan
-    for (int x = 0; x < w; ++x) {
-        for (int y = 0; y < h; ++y) {
-            if (qAlpha(image.pixel(x, y))) {
-                // Found an opaque pixel.
-                return false;
-            }
-        }
+    // the pixels are passed through the shared memory if possible (no copying through the X socket)
+    xcb_image_t *image = getImageShm(clientWindowSize, depth);
+    if (!image) {
+        image = xcb_image_get(c, m_windowId, 0, 0, clientWindowSize.width(), clientWindowSize.height(), 0xFFFFFFFF, XCB_IMAGE_FORMAT_Z_PIXMAP);
     }
 
-    return true;
-}
-
-QImage SNIProxy::getImageNonComposite() const
-{
-    auto c = QX11Info::connection();
-
-    QSize clientWindowSize = calculateClientWindowSize();
-
-    xcb_image_t *image = xcb_image_get(c, m_windowId, 0, 0, clientWindowSize.width(), clientWindowSize.height(), 0xFFFFFFFF, XCB_IMAGE_FORMAT_Z_PIXMAP);
+    m_nativeAlpha = false;
 
     // Don't hook up cleanup yet, we may use a different QImage after all
     QImage naiveConversion;
@@ -333,24 +472,164 @@ QImage SNIProxy::getImageNonComposite() const
         return QImage();
     }
 
-    if (isTransparentImage(naiveConversion)) {
+    opaqueArea = findOpaqueArea(naiveConversion);
+    if (opaqueArea.isEmpty()) {
         QImage elaborateConversion = QImage(convertFromNative(image));
 
         // Update icon only if it is at least partially opaque.
         // This is just a workaround for X11 bug: xembed icon may suddenly
         // become transparent for a one or few frames. Reproducible at least
         // with WINE applications.
-        if (isTransparentImage(elaborateConversion)) {
+        opaqueArea = findOpaqueArea(elaborateConversion);
+        if (opaqueArea.isEmpty()) {
             qDebug() << "Skip transparent xembed icon for" << m_windowId << Title();
             return QImage();
         } else
             return elaborateConversion;
     } else {
+        m_nativeAlpha = true;
         // Now we are sure we can eventually delete the xcb_image_t with this version
         return QImage(image->data, image->width, image->height, image->stride, QImage::Format_ARGB32, sni_cleanup_xcb_image, image);
     }
 }
 
+bool SNIProxy::captureDamaged(const QRect &damaged, QRect &opaqueArea)
+{
+    // the other conversions (e.g. the heuristic mask) need the whole image
+    if (!m_nativeAlpha || m_windowImage.isNull() || m_windowResized || damaged.isEmpty()) {
+        return false;
+    }
+    const int windowArea = m_windowImage.width() * m_windowImage.height();
+    // outside of the image or not worth it
+    if (!m_windowImage.rect().contains(damaged) || damaged.width() * damaged.height() * 2 > windowArea) {
+        return false;
+    }
+
+    auto c = QX11Info::connection();
+    xcb_image_t *image = xcb_image_get(c, m_windowId, damaged.x(), damaged.y(), damaged.width(), damaged.height(), 0xFFFFFFFF, XCB_IMAGE_FORMAT_Z_PIXMAP);
+    if (!image) {
+        return false;
+    }
+    if (image->bpp != 32) {
+        xcb_image_destroy(image);
+        return false;
+    }
+
+    const QImage patch(image->data, image->width, image->height, image->stride, QImage::Format_ARGB32, sni_cleanup_xcb_image, image);
+    const int lineBytes = damaged.width() * 4;
+    for (int y = 0; y < damaged.height(); ++y) {
+        memcpy(m_windowImage.scanLine(damaged.y() + y) + damaged.x() * 4, patch.constScanLine(y), lineBytes);
+    }
+
+    // the opaque area can shrink only if the damage reaches its edges
+    const QRect &box = m_opaqueArea;
+    const bool edgeDamaged = box.isEmpty()
+        || damaged.intersects(QRect{box.left(), box.top(), box.width(), 1})
+        || damaged.intersects(QRect{box.left(), box.bottom(), box.width(), 1})
+        || damaged.intersects(QRect{box.left(), box.top(), 1, box.height()})
+        || damaged.intersects(QRect{box.right(), box.top(), 1, box.height()});
+    if (edgeDamaged) {
+        opaqueArea = findOpaqueArea(m_windowImage);
+    } else {
+        const QRect patchArea = findOpaqueArea(patch);
+        opaqueArea = patchArea.isEmpty() ? box : box | patchArea.translated(damaged.topLeft());
+    }
+
+    // (suddenly) transparent -> the whole capture decides
+    return !opaqueArea.isEmpty();
+}
+
+xcb_image_t *SNIProxy::getImageShm(const QSize &size, uint8_t depth)
+{
+    if (!s_shmUsable || size.isEmpty() || 0 == depth) {
+        return nullptr;
+    }
+
+    auto c = QX11Info::connection();
+
+    // the image (with its own data) in the layout the server will send it
+    xcb_image_t *image = xcb_image_create_native(c, size.width(), size.height(), XCB_IMAGE_FORMAT_Z_PIXMAP, depth, nullptr, ~0, nullptr);
+    if (!image) {
+        return nullptr;
+    }
+    if (!ensureShmSegment(image->size)) {
+        xcb_image_destroy(image);
+        return nullptr;
+    }
+
+    xcb_image_t *shmImage = xcb_image_create_native(c, size.width(), size.height(), XCB_IMAGE_FORMAT_Z_PIXMAP, depth, nullptr, image->size, static_cast<uint8_t *>(m_shm.shmaddr));
+    if (!shmImage || !xcb_image_shm_get(c, m_windowId, shmImage, m_shm, 0, 0, 0xFFFFFFFF)) {
+        if (shmImage) {
+            xcb_image_destroy(shmImage);
+        }
+        xcb_image_destroy(image);
+        return nullptr;
+    }
+
+    // the segment is reused for the next capture -> the image needs its own (local) copy
+    memcpy(image->data, shmImage->data, image->size);
+    xcb_image_destroy(shmImage); // doesn't free the (not owned) data
+    return image;
+}
+
+bool SNIProxy::ensureShmSegment(uint32_t size)
+{
+    if (m_shmSize >= size) {
+        return true;
+    }
+
+    releaseShmSegment();
+
+    auto c = QX11Info::connection();
+    const auto *ext = xcb_get_extension_data(c, &xcb_shm_id);
+    if (!ext || !ext->present) {
+        s_shmUsable = false;
+        return false;
+    }
+
+    m_shm.shmid = shmget(IPC_PRIVATE, size, IPC_CREAT | 0600);
+    if (m_shm.shmid < 0) {
+        qWarning() << "Unable to create shared memory segment, falling back to plain capture";
+        s_shmUsable = false;
+        return false;
+    }
+    m_shm.shmaddr = static_cast<uint8_t *>(shmat(m_shm.shmid, nullptr, 0));
+    if (reinterpret_cast<uint8_t *>(-1) == m_shm.shmaddr) {
+        shmctl(m_shm.shmid, IPC_RMID, nullptr);
+        m_shm = {0, -1, nullptr};
+        s_shmUsable = false;
+        return false;
+    }
+
+    m_shm.shmseg = xcb_generate_id(c);
+    QScopedPointer<xcb_generic_error_t, QScopedPointerPodDeleter> error(xcb_request_check(c, xcb_shm_attach_checked(c, m_shm.shmseg, m_shm.shmid, false)));
+    // the segment is destroyed as soon as both of us detach
+    shmctl(m_shm.shmid, IPC_RMID, nullptr);
+    if (error) {
+        // e.g. remote X server
+        qWarning() << "X server can't attach shared memory segment, falling back to plain capture";
+        shmdt(m_shm.shmaddr);
+        m_shm = {0, -1, nullptr};
+        s_shmUsable = false;
+        return false;
+    }
+
+    m_shmSize = size;
+    return true;
+}
+
+void SNIProxy::releaseShmSegment()
+{
+    if (0 == m_shmSize) {
+        return;
+    }
+
+    xcb_shm_detach(QX11Info::connection(), m_shm.shmseg);
+    shmdt(m_shm.shmaddr);
+    m_shm = {0, -1, nullptr};
+    m_shmSize = 0;
+}
+
 QImage SNIProxy::convertFromNative(xcb_image_t *xcbImage) const
 {
     QImage::Format format = QImage::Format_Invalid;
@@ -413,31 +692,21 @@ QImage SNIProxy::convertFromNative(xcb_image_t *xcbImage) const
   Wine is using XWindow Shape Extension for transparent tray icons.
   We need to find first clickable point starting from top-left.
 */
-QPoint SNIProxy::calculateClickPoint() const
+QPoint SNIProxy::calculateClickPoint(xcb_shape_query_extents_reply_t *extentsReply, xcb_shape_get_rectangles_reply_t *rectanglesReply) const
 {
     QPoint clickPoint = QPoint(0, 0);
 
-    auto c = QX11Info::connection();
-
-    // request extent to check if shape has been set
-    xcb_shape_query_extents_cookie_t extentsCookie = xcb_shape_query_extents(c, m_windowId);
-    // at the same time make the request for rectangles (even if this request isn't needed)
-    xcb_shape_get_rectangles_cookie_t rectaglesCookie = xcb_shape_get_rectangles(c, m_windowId, XCB_SHAPE_SK_BOUNDING);
-
-    QScopedPointer<xcb_shape_query_extents_reply_t, QScopedPointerPodDeleter> extentsReply(xcb_shape_query_extents_reply(c, extentsCookie, nullptr));
-    QScopedPointer<xcb_shape_get_rectangles_reply_t, QScopedPointerPodDeleter> rectanglesReply(xcb_shape_get_rectangles_reply(c, rectaglesCookie, nullptr));
-
     if (!extentsReply || !rectanglesReply || !extentsReply->bounding_shaped) {
         return clickPoint;
     }
 
-    xcb_rectangle_t *rectangles = xcb_shape_get_rectangles_rectangles(rectanglesReply.get());
+    xcb_rectangle_t *rectangles = xcb_shape_get_rectangles_rectangles(rectanglesReply);
     if (!rectangles) {
         return clickPoint;
     }
 
     double minLength = sqrt(pow(m_windowImage.height(), 2) + pow(m_windowImage.width(), 2));
-    const int nRectangles = xcb_shape_get_rectangles_rectangles_length(rectanglesReply.get());
+    const int nRectangles = xcb_shape_get_rectangles_rectangles_length(rectanglesReply);
     for (int i = 0; i < nRectangles; ++i) {
         double length = sqrt(pow(rectangles[i].x, 2) + pow(rectangles[i].y, 2));
         if (length < minLength) {
@@ -476,6 +745,14 @@ QString SNIProxy::Id() const
 
 KDbusImageVector SNIProxy::IconPixmap() const
 {
+    // computed once per captured frame, all the reads (hosts) share the (implicitly shared) vector
+    if (const auto stats = TrayStats::instance()) {
+        stats->iconPixmapRead(!m_iconPixmapsValid);
+    }
+    if (m_iconPixmapsValid) {
+        return m_iconPixmaps;
+    }
+
     KDbusImageVector v{m_iconImage};
     // add pixmaps up to s_embedSize resolution (for the SNI presenter to be able to choose, if needed)
     for (int s = 16; s <= s_embedSize && !m_iconImage.isNull(); s <<= 1)
@@ -485,6 +762,8 @@ KDbusImageVector SNIProxy::IconPixmap() const
             v << m_iconImage.scaled(s, s, Qt::KeepAspectRatio, Qt::SmoothTransformation);
         }
     }
+    m_iconPixmaps = v;
+    m_iconPixmapsValid = true;
     return v;
 }
 
@@ -546,26 +825,34 @@ void SNIProxy::sendClick(uint8_t mouseButton, int x, int y)
     // ideally we should make this match the plasmoid hit area
 
     qDebug() << "Received click" << mouseButton << "with passed x*y" << x << y;
-    sendingClickEvent = true;
 
     auto c = QX11Info::connection();
 
+    // issue all the queries at once, so they cost a single round trip
     auto cookieSize = xcb_get_geometry(c, m_windowId);
+    auto cookiePointer = xcb_query_pointer(c, m_windowId);
+    // Wine is using XWindow Shape Extension for transparent tray icons,
+    // request extent to check if shape has been set and the rectangles (even if they aren't needed)
+    auto cookieExtents = xcb_shape_query_extents(c, m_windowId);
+    auto cookieRectangles = xcb_shape_get_rectangles(c, m_windowId, XCB_SHAPE_SK_BOUNDING);
+
     QScopedPointer<xcb_get_geometry_reply_t, QScopedPointerPodDeleter> clientGeom(xcb_get_geometry_reply(c, cookieSize, nullptr));
+    QScopedPointer<xcb_query_pointer_reply_t, QScopedPointerPodDeleter> pointer(xcb_query_pointer_reply(c, cookiePointer, nullptr));
+    QScopedPointer<xcb_shape_query_extents_reply_t, QScopedPointerPodDeleter> extentsReply(xcb_shape_query_extents_reply(c, cookieExtents, nullptr));
+    QScopedPointer<xcb_shape_get_rectangles_reply_t, QScopedPointerPodDeleter> rectanglesReply(xcb_shape_get_rectangles_reply(c, cookieRectangles, nullptr));
 
-    if (!clientGeom) {
+    if (!clientGeom || !pointer) {
         return;
     }
-
-    auto cookie = xcb_query_pointer(c, m_windowId);
-    QScopedPointer<xcb_query_pointer_reply_t, QScopedPointerPodDeleter> pointer(xcb_query_pointer_reply(c, cookie, nullptr));
     /*qDebug() << "samescreen" << pointer->same_screen << endl
     << "root x*y" << pointer->root_x << pointer->root_y << endl
     << "win x*y" << pointer->win_x << pointer->win_y;*/
 
-    // move our window so the mouse is within its geometry
-    uint32_t configVals[2] = {0, 0};
-    const QPoint clickPoint = calculateClickPoint();
+    sendingClickEvent = true;
+
+    // move our window so the mouse is within its geometry and pull it up, in one request
+    uint32_t configVals[3] = {0, 0, XCB_STACK_MODE_ABOVE};
+    const QPoint clickPoint = calculateClickPoint(extentsReply.get(), rectanglesReply.get());
     if (mouseButton >= XCB_BUTTON_INDEX_4) {
         // scroll event, take pointer position
         configVals[0] = pointer->root_x;
@@ -580,60 +867,39 @@ void SNIProxy::sendClick(uint8_t mouseButton, int x, int y)
         else
             configVals[1] = static_cast<uint32_t>(y - clickPoint.y());
     }
-    xcb_configure_window(c, m_containerWid, XCB_CONFIG_WINDOW_X | XCB_CONFIG_WINDOW_Y, configVals);
+    xcb_configure_window(c, m_containerWid, XCB_CONFIG_WINDOW_X | XCB_CONFIG_WINDOW_Y | XCB_CONFIG_WINDOW_STACK_MODE, configVals);
 
-    // pull window up
-    stackContainerWindow(XCB_STACK_MODE_ABOVE);
-
-    // mouse down
     if (m_injectMode == Direct) {
-        xcb_button_press_event_t *event = new xcb_button_press_event_t;
-        memset(event, 0x00, sizeof(xcb_button_press_event_t));
-        event->response_type = XCB_BUTTON_PRESS;
-        event->event = m_windowId;
-        event->time = QX11Info::getTimestamp();
-        event->same_screen = 1;
-        event->root = QX11Info::appRootWindow();
-        event->root_x = x;
-        event->root_y = y;
-        event->event_x = static_cast<int16_t>(clickPoint.x());
-        event->event_y = static_cast<int16_t>(clickPoint.y());
-        event->child = 0;
-        event->state = 0;
-        event->detail = mouseButton;
-
-        xcb_send_event(c, false, m_windowId, XCB_EVENT_MASK_BUTTON_PRESS, (char *)event);
-        delete event;
+        // press & release differ only in the type (the timestamp is fetched once, it costs a round trip)
+        xcb_button_press_event_t event;
+        memset(&event, 0x00, sizeof(event));
+        event.event = m_windowId;
+        event.time = QX11Info::getTimestamp();
+        event.same_screen = 1;
+        event.root = QX11Info::appRootWindow();
+        event.root_x = x;
+        event.root_y = y;
+        event.event_x = static_cast<int16_t>(clickPoint.x());
+        event.event_y = static_cast<int16_t>(clickPoint.y());
+        event.child = 0;
+        event.state = 0;
+        event.detail = mouseButton;
+
+        // mouse down
+        event.response_type = XCB_BUTTON_PRESS;
+        xcb_send_event(c, false, m_windowId, XCB_EVENT_MASK_BUTTON_PRESS, reinterpret_cast<const char *>(&event));
+        // mouse up
+        event.response_type = XCB_BUTTON_RELEASE;
+        xcb_send_event(c, false, m_windowId, XCB_EVENT_MASK_BUTTON_RELEASE, reinterpret_cast<const char *>(&event));
     } else {
         sendXTestPressed(QX11Info::display(), mouseButton);
-    }
-
-    // mouse up
-    if (m_injectMode == Direct) {
-        xcb_button_release_event_t *event = new xcb_button_release_event_t;
-        memset(event, 0x00, sizeof(xcb_button_release_event_t));
-        event->response_type = XCB_BUTTON_RELEASE;
-        event->event = m_windowId;
-        event->time = QX11Info::getTimestamp();
-        event->same_screen = 1;
-        event->root = QX11Info::appRootWindow();
-        event->root_x = x;
-        event->root_y = y;
-        event->event_x = static_cast<int16_t>(clickPoint.x());
-        event->event_y = static_cast<int16_t>(clickPoint.y());
-        event->child = 0;
-        event->state = 0;
-        event->detail = mouseButton;
-
-        xcb_send_event(c, false, m_windowId, XCB_EVENT_MASK_BUTTON_RELEASE, (char *)event);
-        delete event;
-    } else {
         sendXTestReleased(QX11Info::display(), mouseButton);
     }
 
 #ifndef VISUAL_DEBUG
     stackContainerWindow(XCB_STACK_MODE_BELOW);
 #endif
+    xcb_flush(c);
 
     sendingClickEvent = false;
 }
@@ -33,15 +33,19 @@
 #include <QObject>
 #include <QImage>
 #include <QPoint>
+#include <QRect>
 
 #include <xcb/xcb.h>
 #include <xcb/xcb_image.h>
+#include <xcb/shm.h>
+#include <xcb/shape.h>
 
 #include "snidbus.h"
 
 namespace Xcb {
     class Atoms;
 }
+class OrgKdeStatusNotifierWatcherInterface;
 
 class SNIProxy : public QObject
 {
@@ -55,10 +59,31 @@ class SNIProxy : public QObject
     Q_PROPERTY(KDbusImageVector IconPixmap READ IconPixmap)
 
 public:
-    explicit SNIProxy(xcb_window_t wid, Xcb::Atoms & atoms, QObject *parent = nullptr);
+    /**
+     * Issues the X requests for embedding the window, without waiting for any reply
+     * (so several windows can be docked in one round trip).
+     * @param sharedDBus put the item on the connection shared by all the proxies
+     * @see finishInit, watcherTracksPaths
+     */
+    SNIProxy(xcb_window_t wid, Xcb::Atoms & atoms, bool sharedDBus, QObject *parent = nullptr);
     ~SNIProxy() override;
 
-    void update();
+    /**
+     * Collects the replies of the requests issued by the constructor.
+     * The caller is responsible for flushing the connection.
+     */
+    void finishInit();
+
+    /**
+     * @return whether the watcher can unregister the items by path (a round trip)
+     */
+    static bool watcherTracksPaths();
+
+    /**
+     * Captures the icon
+     * @param damaged the changed part of the window (null for capturing the whole window)
+     */
+    void update(const QRect &damaged = QRect{});
     void resizeWindow(const uint16_t width, const uint16_t height) const;
     void hideContainerWindow(xcb_window_t windowId) const;
     inline void vanished(bool vanished) { m_vanished = vanished; }
@@ -159,22 +184,46 @@ private:
         XTest,
     };
 
-    QSize calculateClientWindowSize() const;
+    QSize calculateClientWindowSize(uint8_t *depth = nullptr) const;
+    QSize clientWindowSizeOf(xcb_get_geometry_reply_t *clientGeom, uint8_t *depth = nullptr) const;
     void sendClick(uint8_t mouseButton, int x, int y);
-    QImage getImageNonComposite() const;
-    bool isTransparentImage(const QImage &image) const;
+    /**
+     * @param opaqueArea the bounding box of the non-transparent pixels
+     */
+    QImage getImageNonComposite(QRect &opaqueArea);
+    /**
+     * Captures just the damaged part into the current image
+     * @return false if the whole window must be captured
+     */
+    bool captureDamaged(const QRect &damaged, QRect &opaqueArea);
+    xcb_image_t *getImageShm(const QSize &size, uint8_t depth);
+    bool ensureShmSegment(uint32_t size);
+    void releaseShmSegment();
     QImage convertFromNative(xcb_image_t *xcbImage) const;
-    QPoint calculateClickPoint() const;
+    QPoint calculateClickPoint(xcb_shape_query_extents_reply_t *extentsReply, xcb_shape_get_rectangles_reply_t *rectanglesReply) const;
     void stackContainerWindow(const uint32_t stackMode) const;
 
+    bool m_sharedDBus; //!< the item is an object on the connection shared by all the proxies
     QDBusConnection m_dbus;
+    QString m_dbusPath;
+    OrgKdeStatusNotifierWatcherInterface *m_statusNotifierWatcher = nullptr;
     xcb_window_t m_windowId;
     xcb_window_t m_containerWid;
     static int s_serviceCount;
     QImage m_windowImage;
     QImage m_iconImage;
+    QRect m_opaqueArea; //!< of the m_windowImage
+    bool m_nativeAlpha = false; //!< m_windowImage is the plain ARGB32 interpretation of the window pixels
+    mutable bool m_windowResized = false; //!< the window was resized since m_windowImage was captured
+    uint m_iconHash = 0; //!< hash of the last announced icon
+    mutable KDbusImageVector m_iconPixmaps; //!< the IconPixmap variants of the current frame (lazily)
+    mutable bool m_iconPixmapsValid = false;
     bool sendingClickEvent;
     InjectMode m_injectMode;
     Xcb::Atoms & m_atoms;
+    xcb_get_geometry_cookie_t m_geometryCookie; //!< for finishInit
+    xcb_get_window_attributes_cookie_t m_attributesCookie;
     bool m_vanished = false;
+    xcb_shm_segment_info_t m_shm; //!< shared memory segment for the capture (reused)
+    uint32_t m_shmSize = 0;
 };
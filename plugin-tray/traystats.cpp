@@ -0,0 +1,139 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * LXQt - a lightweight, Qt based, desktop toolset
+ * https://lxqt.org
+ *
+ * Copyright: 2026 LXQt team
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "traystats.h"
+
+#include <algorithm>
+#include <memory>
+#include <sys/resource.h>
+
+static qint64 processCpuTime()
+{
+    struct rusage usage;
+    if (0 != getrusage(RUSAGE_SELF, &usage)) {
+        return 0;
+    }
+    return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000LL + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+TrayStats *TrayStats::instance()
+{
+    static const std::unique_ptr<TrayStats> stats{[] () -> TrayStats * {
+        if (!qEnvironmentVariableIsSet("LXQT_TRAY_STATS")) {
+            return nullptr;
+        }
+        bool ok = false;
+        const int interval = qEnvironmentVariableIntValue("LXQT_TRAY_STATS", &ok);
+        return new TrayStats{ok && 0 < interval ? interval : 10};
+    }()};
+    return stats.get();
+}
+
+TrayStats::TrayStats(int interval)
+{
+    m_clock.start();
+    connect(&m_reportTimer, &QTimer::timeout, this, &TrayStats::report);
+    m_reportTimer.start(interval * 1000);
+    reset();
+}
+
+void TrayStats::reset()
+{
+    m_wallTime.start();
+    m_cpuTime = processCpuTime();
+    m_damages = m_captures = m_failed = m_unchanged = m_announced = m_pixmapReads = m_pixmapComputed = 0;
+    m_captureTime = 0;
+    m_latencies.clear();
+}
+
+void TrayStats::docked()
+{
+    ++m_icons;
+}
+
+void TrayStats::undocked(xcb_window_t window)
+{
+    --m_icons;
+    m_damagedSince.remove(window);
+}
+
+void TrayStats::damaged(xcb_window_t window)
+{
+    ++m_damages;
+    if (!m_damagedSince.contains(window)) {
+        m_damagedSince.insert(window, m_clock.nsecsElapsed());
+    }
+}
+
+void TrayStats::captured(xcb_window_t window, qint64 duration)
+{
+    ++m_captures;
+    m_captureTime += duration;
+    const auto since = m_damagedSince.find(window);
+    if (since != m_damagedSince.end()) {
+        m_latencies.append(m_clock.nsecsElapsed() - *since);
+        m_damagedSince.erase(since);
+    }
+}
+
+void TrayStats::captureFailed()
+{
+    ++m_failed;
+}
+
+void TrayStats::iconUnchanged()
+{
+    ++m_unchanged;
+}
+
+void TrayStats::iconAnnounced()
+{
+    ++m_announced;
+}
+
+void TrayStats::iconPixmapRead(bool computed)
+{
+    ++m_pixmapReads;
+    if (computed) {
+        ++m_pixmapComputed;
+    }
+}
+
+void TrayStats::report()
+{
+    const double seconds = m_wallTime.nsecsElapsed() / 1e9;
+    const double cpu = (processCpuTime() - m_cpuTime) / 1e4 / seconds;
+
+    std::sort(m_latencies.begin(), m_latencies.end());
+    auto percentile = [this] (int p) {
+        return m_latencies.isEmpty() ? 0.0 : m_latencies[qMin(m_latencies.count() - 1, m_latencies.count() * p / 100)] / 1e6;
+    };
+    qInfo("TrayStats: %d icons, panel CPU %.1f %%, %d damages, %.1f captures/s (%d unchanged, %d failed, avg %.2f ms)"
+          ", damage to capture p50 %.1f ms p99 %.1f ms, %d icons announced (%d D-Bus signals), %d IconPixmap reads (%d computed)"
+          , m_icons, cpu, m_damages, m_captures / seconds, m_unchanged, m_failed, m_captures ? m_captureTime / 1e6 / m_captures : 0.0
+          , percentile(50), percentile(99), m_announced, 2 * m_announced, m_pixmapReads, m_pixmapComputed);
+
+    reset();
+}
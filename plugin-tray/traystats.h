@@ -0,0 +1,95 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * LXQt - a lightweight, Qt based, desktop toolset
+ * https://lxqt.org
+ *
+ * Copyright: 2026 LXQt team
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#pragma once
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QTimer>
+#include <QVector>
+
+#include <xcb/xcb.h>
+
+/**
+ * Throughput statistics of the xembed proxies, periodically written to the log.
+ *
+ * Enabled by the LXQT_TRAY_STATS environment variable, its value is the report
+ * interval in seconds (10 if not a number). It is meant for sizing how many legacy
+ * tray icons a machine can handle: the numbers are taken from a real session,
+ * with the real clients.
+ */
+class TrayStats : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @return the statistics, nullptr if they are not enabled
+     */
+    static TrayStats *instance();
+
+    void docked();
+    void undocked(xcb_window_t window);
+    void damaged(xcb_window_t window);
+    /**
+     * The icon of the damaged window was captured
+     * @param duration the time taken by the capture (ns)
+     */
+    void captured(xcb_window_t window, qint64 duration);
+    void captureFailed();
+    void iconUnchanged();
+    /**
+     * A new icon was announced (the NewIcon & NewToolTip signals emitted)
+     */
+    void iconAnnounced();
+    /**
+     * @param computed the variants were computed (not taken from the cache)
+     */
+    void iconPixmapRead(bool computed);
+
+private Q_SLOTS:
+    void report();
+
+private:
+    explicit TrayStats(int interval);
+    void reset();
+
+    QTimer m_reportTimer;
+    QElapsedTimer m_wallTime;
+    qint64 m_cpuTime = 0; //!< CPU time of the process at the start of the interval (us)
+    int m_icons = 0;
+    int m_damages = 0;
+    int m_captures = 0;
+    int m_failed = 0;
+    int m_unchanged = 0;
+    int m_announced = 0;
+    int m_pixmapReads = 0;
+    int m_pixmapComputed = 0;
+    qint64 m_captureTime = 0; //!< ns
+    QHash<xcb_window_t, qint64> m_damagedSince; //!< first damage not yet captured (ns since start)
+    QVector<qint64> m_latencies; //!< damage -> capture (ns)
+    QElapsedTimer m_clock;
+};